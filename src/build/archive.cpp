@@ -0,0 +1,120 @@
+#include "archive.h"
+#include "process.h"
+#include "rsp.h"
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+using std::string;
+using std::vector;
+namespace fs = std::filesystem;
+
+namespace Y::Build {
+
+// format: first line -> "<archiver> <1 if thin>", then one member per line -> "<content hash> <object>"
+// returns false if there is no manifest or it was written for another archiver/kind of archive.
+bool LoadArchiveManifest(const string &manifestPath, const string &header, std::map<string, string> &members)
+{
+    std::ifstream manifest(manifestPath);
+    string line;
+    if(!std::getline(manifest, line) || line != header)
+        return false;
+
+    while(std::getline(manifest, line))
+    {
+        usize space = line.find(' ');
+        if(space != string::npos)
+            members[line.substr(space + 1)] = line.substr(0, space);
+    }
+
+    return true;
+}
+
+void SaveArchiveManifest(const string &manifestPath, const string &header, const std::map<string, string> &members)
+{
+    std::ofstream manifest(manifestPath, std::ios::out | std::ios::trunc);
+    manifest << header << "\n";
+    for(const auto &[object, hash] : members)
+        manifest << hash << " " << object << "\n";
+}
+
+i32 RunArchiver(const string &command)
+{
+    LTRACE(true, "COMMAND TO ARCHIVE: \n\t", command, "\n");
+    return RunProcess(command + COMP_SUPPRESS_OUTPUT).exitCode;
+}
+
+i32 UpdateStaticArchive(const string &archiver, const string &archive, const vector<string> &objects, bool thin,
+                        const string &manifestPath, const string &rspPath)
+{
+    string header = archiver + " " + (thin ? "1" : "0");
+
+    std::map<string, string> hashes;
+    for(const string &object : objects)
+        hashes[object] = Cache::HashFile(object);
+
+    std::map<string, string> members;
+    bool incremental = Cache::FileExists(archive.c_str()) && LoadArchiveManifest(manifestPath, header, members);
+
+    vector<string> changed;
+    for(const string &object : objects)
+    {
+        auto member = members.find(object);
+        if(member == members.end() || member->second != hashes[object])
+            changed.push_back(object);
+    }
+
+    // members are named after the objects' filenames.
+    vector<string> removed;
+    for(const auto &[object, hash] : members)
+    {
+        if(hashes.find(object) == hashes.end())
+            removed.push_back(fs::path(object).filename().string());
+    }
+
+    // a thin archive only holds references, it's rebuilt instead.
+    if(thin && !removed.empty())
+        incremental = false;
+
+    i32 exitCode = 0;
+    if(!incremental)
+    {
+        // ar rcs would keep the members of the old archive.
+        std::error_code ec;
+        fs::remove(archive, ec);
+
+        exitCode = RunArchiver(AR_CREATE(archiver, thin, archive) + GetFileArgs(objects, rspPath));
+    }
+    else if(changed.empty() && removed.empty())
+    {
+        LTRACE(true, "static archive is up to date: ", archive, "\n");
+        return 0;
+    }
+    else
+    {
+        if(!removed.empty())
+            exitCode = RunArchiver(AR_DELETE(archiver, archive) + GetFileArgs(removed, rspPath));
+        if(exitCode == 0 && !changed.empty())
+            exitCode = RunArchiver(AR_REPLACE(archiver, thin, archive) + GetFileArgs(changed, rspPath));
+        if(exitCode == 0)
+            exitCode = RunArchiver(AR_INDEX(archiver, archive));
+
+        if(exitCode == 0)
+            LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "updated ", changed.size(), "/", objects.size(), " members of ",
+                 CYAN_TEXT(archive), (removed.empty() ? "" : ", removed " + std::to_string(removed.size())), "\n");
+    }
+
+    // the archive is in an unknown state, it's rebuilt next time.
+    if(exitCode != 0)
+    {
+        std::error_code ec;
+        fs::remove(manifestPath, ec);
+        return exitCode;
+    }
+
+    SaveArchiveManifest(manifestPath, header, hashes);
+    return 0;
+}
+
+} // namespace Y::Build
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include "../cache/cache.h"
+
+#include <string>
+#include <vector>
+
+namespace Y::Build {
+
+// creates or updates a static archive with ar. (or gcc-ar/llvm-ar, they take the same commands)
+// the members are recorded (object -> content hash) in 'manifestPath'. when the archive exists, only the objects
+// that changed are replaced (ar r), the ones that are gone are deleted (ar d) and the symbol index is rebuilt
+// (ar s, like ranlib). nothing runs if no object changed.
+// thin archives (ar T) reference the objects instead of copying them. (they can't be moved without the objects)
+// returns the exit code of the command that failed. (0 on success)
+i32 UpdateStaticArchive(const std::string &archiver, const std::string &archive, const std::vector<std::string> &objects,
+                        bool thin, const std::string &manifestPath, const std::string &rspPath);
+
+} // namespace Y::Build
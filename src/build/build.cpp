@@ -19,26 +19,10 @@ string Basepath(string fullpath)
     return path.parent_path().string();
 }
 
-string GetHashedFileNameFromPath(const string &file)
+// compiler (and its executable) for a source file.
+Compiler GetSourceCompiler(const Project &proj, FileType fileType, string &executable)
 {
-    std::hash<string> hasher;
-    usize hashValue = hasher(file);
-    return Basename(file) + "_" + std::to_string(hashValue);
-}
-
-// path/to/file.c -> outDir/file_HASH.o
-string CompileFile(Project proj, const string &file, const string &outDir, BuildMode mode, BuildType type, bool project)
-{
-    // ex: clang -c file.c [flags] -o Concat(outDir, file.o)
-    // flags: linking, optimization, include dirs, defines, etc.
-
-    // compiler.
-    FileType fileType = GetFileType(file);
-    LTRACE(true, "compiling file: ", file, "\n");
-
     Compiler compiler = Compiler::NONE;
-    string command    = "";
-
     if(fileType == FileType::C)
     {
         compiler = WhatCompiler(proj.cCompiler);
@@ -47,10 +31,9 @@ string CompileFile(Project proj, const string &file, const string &outDir, Build
         else if(compiler == Compiler::NONE)
             throw Y::Error("no c compiler specified in the project config file.");
 
-        command += proj.cCompiler;
-        command += " ";
+        executable = proj.cCompiler;
     }
-    else if(fileType == FileType::CPP)
+    else
     {
         compiler = WhatCompiler(proj.cppCompiler);
         if(compiler == Compiler::UNKOWN)
@@ -58,106 +41,645 @@ string CompileFile(Project proj, const string &file, const string &outDir, Build
         else if(compiler == Compiler::NONE)
             throw Y::Error("no cpp compiler specified in the project config file.");
 
-        command += proj.cppCompiler;
-        command += " ";
+        executable = proj.cppCompiler;
     }
 
-    if(type == BuildType::SHARED_LIB && compiler != Compiler::CLANG)
-        command += (compiler == Compiler::MSVC) ? "" : COMP_POSITION_INDEPENDENT_CODE;
+    return compiler;
+}
+
+// flags shared by every file of a target. (everything but the input file, its directory, and the output)
+// includeSplit is set to where the file's directory goes. (right after the project's include dirs)
+string GetCompileFlags(const Project &proj, Compiler compiler, FileType fileType, BuildMode mode, BuildType type,
+                       bool project, usize *includeSplit = nullptr)
+{
+    const Toolchain &toolchain = GetToolchain(compiler);
+    string command             = "";
 
-    // add -c flag.
-    command += (compiler == Compiler::MSVC) ? COMP_MSVC_COMPILE_ONLY : COMP_COMPILE_ONLY;
-    command += string(file) + " ";
+    if(type == BuildType::SHARED_LIB && compiler != Compiler::CLANG)
+        command += toolchain.positionIndependent;
 
     // add standard.
-    if(fileType == FileType::C)
-    {
-        command += (compiler == Compiler::MSVC) ? "" : COMP_STANDARD_VERSION_C(proj.cStd);
-    }
-    else
-    {
-        command += (compiler == Compiler::MSVC) ? COMP_MSVC_STANDARD_VERSION_C(proj.cppStd)
-                                                : COMP_STANDARD_VERSION_CPP(proj.cppStd);
-    }
+    toolchain.AppendStandard(command, fileType, (fileType == FileType::C) ? proj.cStd : proj.cppStd);
 
     // add includes.
-    for(auto include : proj.includeDirs)
-        command +=
-            (compiler == Compiler::MSVC) ? COMP_MSVC_INCLUDE_DIR(include.c_str()) : COMP_INCLUDE_DIR(include.c_str());
+    for(const auto &include : proj.includeDirs)
+        Toolchain::Append(command, toolchain.includeDir, include);
 
-    command += (compiler == Compiler::MSVC) ? COMP_MSVC_INCLUDE_DIR(Basepath(file).c_str())
-                                            : COMP_INCLUDE_DIR(Basepath(file).c_str());
+    if(includeSplit)
+        *includeSplit = command.size();
 
     // add build dir as include.
-    command += (compiler == Compiler::MSVC) ? COMP_MSVC_INCLUDE_DIR(proj.buildDir.c_str())
-                                            : COMP_INCLUDE_DIR(proj.buildDir.c_str());
+    Toolchain::Append(command, toolchain.includeDir, proj.buildDir);
 
     if(project)
     {
-        for(auto lib : proj.libs)
-        {
-            command += (compiler == Compiler::MSVC) ? COMP_MSVC_INCLUDE_DIR(lib.include.c_str())
-                                                    : COMP_INCLUDE_DIR(lib.include.c_str());
-        }
+        for(const auto &lib : proj.libs)
+            Toolchain::Append(command, toolchain.includeDir, lib.include);
     }
 
     // add defines.
     if(mode == BuildMode::RELEASE)
     {
-        for(auto macro : proj.definesRelease)
-            command +=
-                (compiler == Compiler::MSVC) ? COMP_MSVC_DEFINE_MACRO(macro.c_str()) : COMP_DEFINE_MACRO(macro.c_str());
+        for(const auto &macro : proj.definesRelease)
+            Toolchain::Append(command, toolchain.defineMacro, macro);
     }
     else if(mode == BuildMode::DEBUG)
     {
-        for(auto macro : proj.definesDebug)
-            command +=
-                (compiler == Compiler::MSVC) ? COMP_MSVC_DEFINE_MACRO(macro.c_str()) : COMP_DEFINE_MACRO(macro.c_str());
+        for(const auto &macro : proj.definesDebug)
+            Toolchain::Append(command, toolchain.defineMacro, macro);
     }
 
     // add compiler flags.
     for(auto flag : proj.flagsDebug)
         command += flag + " ";
 
+    // symbol visibility. (of the project, or the library being built)
+    command += GetVisibilityFlags(proj.visibility, compiler, fileType);
+
+    // paths written in the objects relative to the workspace root.
+    command += GetPrefixMapFlags(compiler, (fileType == FileType::C) ? proj.cCompiler : proj.cppCompiler);
+
     // add optimization level.
     if(mode == BuildMode::RELEASE)
     {
-        command += (compiler == Compiler::MSVC) ? COMP_MSVC_OPTIMIZATION_LEVEL(proj.optimizationRelease)
-                                                : COMP_OPTIMIZATION_LEVEL(proj.optimizationRelease);
+        toolchain.AppendOptimization(command, proj.optimizationRelease);
+
+        // link time optimization. (release only)
+        command += GetLTOCompileFlags(proj.lto, compiler);
+        command += GetPostLinkCompileFlags(proj.postLink);
+        command += GetLinkPresetCompileFlags(proj.linkPreset, compiler);
     }
     else if(mode == BuildMode::DEBUG)
     {
-        command += (compiler == Compiler::MSVC) ? COMP_MSVC_OPTIMIZATION_LEVEL(proj.optimizationDebug)
-                                                : COMP_OPTIMIZATION_LEVEL(proj.optimizationDebug);
+        toolchain.AppendOptimization(command, proj.optimizationDebug);
+
+        // split/compressed debug info. (debug only)
+        string executable = (fileType == FileType::C) ? proj.cCompiler : proj.cppCompiler;
+        command += GetDebugInfoCompileFlags(proj.splitDwarf, proj.dwp, proj.compressDebug, compiler, executable);
     }
 
-    // output.
-    string outFilepath = GetHashedFileNameFromPath(file) + ((compiler == Compiler::MSVC) ? ".obj" : ".o");
-    string outPath     = string(outDir) + "/" + outFilepath;
+    // profile guided optimization. (--pgo, any mode)
+    command += GetPGOFlags(proj.pgo, compiler, GetPGODir(proj.name));
 
-    command += (compiler == Compiler::MSVC) ? COMP_MSVC_OUTPUT_FILE(outPath) : COMP_OUTPUT_FILE(outPath);
+    return command;
+}
+
+// builds (or reuses) the precompiled header of a project or a library. (setting: a header path, or "auto")
+// it's built per target, mode and compiler with the flags of the files using it, for the main language of the
+// project. rebuilt is set if the files using it must be recompiled.
+PCH PreparePCH(const Project &proj, const string &setting, const vector<string> &files, const string &target,
+               BuildMode mode, BuildType type, bool project, bool &rebuilt)
+{
+    rebuilt = false;
+    if(setting.empty())
+        return PCH{};
+
+    FileType lang = (std::find(proj.langs.begin(), proj.langs.end(), Lang::CPP) != proj.langs.end()) ? FileType::CPP
+                                                                                                    : FileType::C;
+    string executable;
+    Compiler compiler = GetSourceCompiler(proj, lang, executable);
+    if(compiler != Compiler::GCC && compiler != Compiler::CLANG)
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "precompiled headers are only supported with gcc and clang. (", target,
+             ")\n");
+        return PCH{};
+    }
+
+    vector<string> headers;
+    if(setting == YMAKE_PCH_AUTO)
+    {
+        vector<string> langFiles;
+        for(const auto &file : files)
+        {
+            if(GetFileType(file) == lang)
+                langFiles.push_back(file);
+        }
+
+        vector<string> includeDirs = proj.includeDirs;
+        if(project)
+        {
+            for(const auto &lib : proj.libs)
+                includeDirs.push_back(lib.include);
+        }
+
+        string cachePath = string(YMAKE_CACHE_DIR) + "/" + proj.name + "/" + YMAKE_PCH_DIR + "/" + target + "_" +
+                           YMAKE_PCH_AUTO_CACHE_FILENAME;
+        headers = FindAutoPCHHeaders(langFiles, includeDirs, cachePath);
+        if(headers.empty())
+        {
+            LTRACE(true, "pch = auto: no header is included by enough files of: ", target, "\n");
+            return PCH{};
+        }
+    }
+    else
+    {
+        if(!Cache::FileExists(setting.c_str()))
+        {
+            LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "precompiled header not found: ", setting, " (", target, ")\n");
+            return PCH{};
+        }
+        headers.push_back(Cache::ToAbsolutePath(setting));
+    }
+
+    string pchDir = string(YMAKE_CACHE_DIR) + "/" + proj.name + "/" + YMAKE_PCH_DIR + "/" + target + "_" +
+                    ((mode == BuildMode::RELEASE) ? "release" : "debug") + "_" + Basename(executable);
+
+    string compileCommand = executable + " " + GetCompileFlags(proj, compiler, lang, mode, type, project);
+    return BuildPCH(headers, pchDir, compiler, lang, compileCommand, rebuilt);
+}
+
+// c++20 modules of the project's sources. (cpp.std >= 20, gcc or clang)
+// BMIs are kept per mode and compiler, like the precompiled headers.
+ModuleBuild PrepareModules(const Project &proj, const vector<string> &files, BuildMode mode, BuildType type)
+{
+    if(proj.cppStd < YMAKE_MODULES_MIN_CPP_STD)
+        return ModuleBuild{};
+
+    string executable;
+    Compiler compiler = GetSourceCompiler(proj, FileType::CPP, executable);
+    if(compiler != Compiler::GCC && compiler != Compiler::CLANG)
+    {
+        LTRACE(true, "modules are only supported with gcc and clang, not scanning for them.\n");
+        return ModuleBuild{};
+    }
+
+    string bmiDir = string(YMAKE_CACHE_DIR) + "/" + proj.name + "/" + YMAKE_MODULES_DIR + "/" +
+                    ((mode == BuildMode::RELEASE) ? "release" : "debug") + "_" + Basename(executable);
+
+    return ScanModules(files, compiler, executable, GetCompileFlags(proj, compiler, FileType::CPP, mode, type, true),
+                       bmiDir);
+}
+
+// the part of a compile command that is the same for every file of a target. built once per (project, mode,
+// language, build type) before the files are compiled, and only read by the compile jobs.
+struct CompileTemplate
+{
+    Compiler compiler          = Compiler::NONE;
+    const Toolchain *toolchain = nullptr; // flag spellings of the compiler.
+    const char *error          = nullptr; // why the files of this language can't be compiled. (no compiler)
+    string prefix;                        // compiler -c
+    string flags;                         // compile flags.
+    usize includeSplit = 0;               // where the file's directory is included in the flags.
+    string pchFlags;                      // precompiled header. (empty if it's for the other language)
+    string fingerprint;                   // of the compiler binary. (part of the object keys)
+};
+
+struct CompileTemplates
+{
+    CompileTemplate c;
+    CompileTemplate cpp;
+
+    const CompileTemplate &Get(FileType fileType) const { return (fileType == FileType::C) ? c : cpp; }
+};
+
+CompileTemplate MakeCompileTemplate(const Project &proj, FileType fileType, BuildMode mode, BuildType type,
+                                    bool project, const PCH &pch)
+{
+    CompileTemplate templ;
+
+    string executable;
+    try
+    {
+        templ.compiler = GetSourceCompiler(proj, fileType, executable);
+    }
+    catch(Y::Error &err)
+    {
+        // only an error if a file of this language is compiled.
+        templ.error = err.what();
+        return templ;
+    }
+
+    templ.toolchain = &GetToolchain(templ.compiler);
+
+    templ.prefix = executable + " ";
+    templ.prefix += templ.toolchain->compileOnly;
+
+    templ.fingerprint = GetCompilerFingerprint(executable);
+
+    templ.flags = GetCompileFlags(proj, templ.compiler, fileType, mode, type, project, &templ.includeSplit);
+
+    // built with the same flags.
+    if(!pch.output.empty() && pch.lang == fileType)
+        templ.pchFlags = GetPCHFlags(pch);
+
+    return templ;
+}
+
+CompileTemplates MakeCompileTemplates(const Project &proj, BuildMode mode, BuildType type, bool project,
+                                      const PCH &pch)
+{
+    CompileTemplates templates;
+    templates.c   = MakeCompileTemplate(proj, FileType::C, mode, type, project, pch);
+    templates.cpp = MakeCompileTemplate(proj, FileType::CPP, mode, type, project, pch);
+    return templates;
+}
+
+// path/to/file.c -> outDir/HA/file_HASH.o
+string GetObjectPath(const CompileTemplate &templ, const string &file, const string &outDir)
+{
+    return Cache::GetShardedCachePath(outDir, file, string(templ.toolchain->objectExtension));
+}
+
+// the object of 'file' with the template of its language. empty if the language has no compiler.
+string GetObjectPath(const CompileTemplates &templates, const string &file, const string &outDir)
+{
+    const CompileTemplate &templ = templates.Get(GetFileType(file));
+    if(templ.error != nullptr)
+        return "";
+
+    return GetObjectPath(templ, file, outDir);
+}
+
+// the command compiling 'file' to outPath.
+string GetCompileCommand(const CompileTemplate &templ, const string &file, const string &outPath,
+                         const ModuleBuild &modules)
+{
+    // ex: clang -c file.c [flags] -o Concat(outDir, file.o)
+    // flags: linking, optimization, include dirs, defines, etc. (from the template)
+
+    Compiler compiler          = templ.compiler;
+    const Toolchain &toolchain = *templ.toolchain;
+
+    // the parts that depend on the file.
+    string includeDir  = Basepath(file);
+    string moduleFlags = (GetFileType(file) == FileType::CPP) ? GetModuleFlags(modules, file) : "";
+
+    string command;
+    command.reserve(templ.prefix.size() + templ.flags.size() + templ.pchFlags.size() + moduleFlags.size() +
+                    file.size() + includeDir.size() + outPath.size() + 32);
+
+    command += templ.prefix;
+
+    // gcc doesn't know the module interface extensions.
+    if(compiler == Compiler::GCC && IsModuleInterfaceFile(file))
+        command += COMP_LANG_CPP;
+    command += file;
+    command += " ";
+
+    // the file's directory right after the project's include dirs.
+    command.append(templ.flags, 0, templ.includeSplit);
+    Toolchain::Append(command, toolchain.includeDir, includeDir);
+    command.append(templ.flags, templ.includeSplit, string::npos);
+
+    // precompiled header.
+    command += templ.pchFlags;
+
+    // c++20 modules. (where the BMIs are)
+    command += moduleFlags;
+
+    // output.
+    Toolchain::Append(command, toolchain.output, outPath);
 
     // suppress output. NOTE: don't suppress output for compiler errors.
-    // command += (compiler == Compiler::MSVC) ? COMP_MSVC_SUPPRESS_OUTPUT : COMP_SUPPRESS_OUTPUT;
+    // command += toolchain.suppressOutput;
+
+    return command;
+}
+
+// what an object is built with: its command (whitespace collapsed, workspace root as '.') and the compiler binary.
+// (its fingerprint)
+// the object is rebuilt when this changes. empty if the file's language has no compiler.
+string GetObjectCommandKey(const CompileTemplates &templates, const string &file, const string &outDir,
+                           const ModuleBuild &modules, string &outPath)
+{
+    const CompileTemplate &templ = templates.Get(GetFileType(file));
+    if(templ.error != nullptr)
+        return "";
+
+    outPath = GetObjectPath(templ, file, outDir);
+
+    // (the same in every checkout)
+    string command = Cache::RelocateCommand(GetCompileCommand(templ, file, outPath, modules));
+
+    string normalized;
+    normalized.reserve(command.size() + templ.fingerprint.size() + 1);
+    for(char c : command)
+    {
+        bool space = (c == ' ' || c == '\t');
+        if(space && (normalized.empty() || normalized.back() == ' '))
+            continue;
+        normalized.push_back(space ? ' ' : c);
+    }
+    if(!normalized.empty() && normalized.back() == ' ')
+        normalized.pop_back();
+
+    normalized += "\n" + templ.fingerprint;
+
+    // (__DATE__ and __TIME__ come from it)
+    string epoch = GetSourceDateEpoch();
+    if(!epoch.empty())
+        normalized += "\n" + string(YMAKE_SOURCE_DATE_EPOCH_ENV) + "=" + epoch;
+
+    return Cache::HashString(normalized);
+}
+
+// true if the object of 'file' wasn't built with the command it would be built with now.
+bool IsObjectCommandStale(const CompileTemplates &templates, const string &file, const string &outDir,
+                          const ModuleBuild &modules, const Cache::PathMap<string> &commandKeys)
+{
+    string object;
+    string key           = GetObjectCommandKey(templates, file, outDir, modules, object);
+    const string *record = object.empty() ? nullptr : commandKeys.Find(Cache::InternPath(object));
+
+    bool stale = (key.empty() || record == nullptr || *record != key);
+    if(stale)
+        LTRACE(true, "the compile command of ", file, " changed.\n");
+    return stale;
+}
+
+// objects of the old naming (outDir/file_<std::hash of the path>.o, a hash that changes with the standard library
+// ymake is built with) are moved to their sharded path, so the cache survives the upgrade. they're kept as built
+// with the current command, like every object was before the commands were recorded.
+void MigrateLegacyObjects(const CompileTemplates &templates, const vector<string> &files, const string &outDir,
+                          const ModuleBuild &modules, Cache::PathMap<string> &commandKeys)
+{
+    usize migrated = 0;
+    for(const auto &file : files)
+    {
+        const CompileTemplate &templ = templates.Get(GetFileType(file));
+        if(templ.error != nullptr)
+            continue;
+
+        string legacyName = outDir + "/" + Basename(file) + "_" + std::to_string(std::hash<string>{}(file));
+        string legacy     = legacyName + string(templ.toolchain->objectExtension);
+        if(!Cache::FileExists(legacy.c_str()))
+            continue;
+
+        string object;
+        string key = GetObjectCommandKey(templates, file, outDir, modules, object);
+
+        std::error_code ec;
+        fs::create_directories(fs::path(object).parent_path(), ec);
+        fs::rename(legacy, object, ec);
+        if(ec)
+            continue;
+
+        // (and the preprocessed file next to it)
+        fs::rename(legacyName + ".i", Cache::GetShardedCachePath(outDir, file, ".i"), ec);
+
+        commandKeys.Erase(Cache::InternPath(legacy));
+        commandKeys[Cache::InternPath(object)] = key;
+        migrated++;
+    }
+
+    if(migrated > 0)
+    {
+        Cache::SaveObjectCommandsCache(outDir, commandKeys);
+        LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "moved ", migrated, " object(s) of ", outDir, " to the new cache layout.\n");
+    }
+}
+
+// records the command keys of the objects built from 'files' and forgets the ones that weren't built. (the records
+// of the other objects are kept)
+void SaveObjectCommandKeys(const CompileTemplates &templates, const vector<string> &files, const string &outDir,
+                           const ModuleBuild &modules, const vector<string> &compiledFiles,
+                           Cache::PathMap<string> &commandKeys)
+{
+    Cache::PathMap<bool> built;
+    built.Reserve(compiledFiles.size());
+    for(const auto &compiled : compiledFiles)
+        built[Cache::InternPath(compiled)] = true;
+
+    for(const auto &file : files)
+    {
+        string object;
+        string key = GetObjectCommandKey(templates, file, outDir, modules, object);
+        if(object.empty())
+            continue;
+
+        Cache::PathId id = Cache::InternPath(object);
+        if(!key.empty() && built.Contains(id))
+            commandKeys[id] = key;
+        else
+            commandKeys.Erase(id);
+    }
+
+    Cache::SaveObjectCommandsCache(outDir, commandKeys);
+}
+
+string CompileFile(const CompileTemplates &templates, const string &file, const string &outDir,
+                   ProcessResult &procResult, const ModuleBuild &modules)
+{
+    // compiler.
+    FileType fileType = GetFileType(file);
+    LTRACE(true, "compiling file: ", file, "\n");
+
+    const CompileTemplate &templ = templates.Get(fileType);
+    if(templ.error != nullptr)
+        throw Y::Error(templ.error);
+
+    string outPath = GetObjectPath(templ, file, outDir);
+    string command = GetCompileCommand(templ, file, outPath, modules);
+
+    // (its shard)
+    std::error_code ec;
+    fs::create_directories(fs::path(outPath).parent_path(), ec);
 
     LTRACE(true, "COMMAND TO COMPILE: \n\t", command.c_str(), "\n");
 
     // compile the file.
-    i32 result = std::system(command.c_str());
-    LASSERT(result == 0, RED_TEXT("[YMAKE COMPILE ERROR]: "), "failed to compile source file: ", file, "\n\t",
-            "exit code: ", result, "\n");
+    procResult = RunProcess(command);
+    if(procResult.oomKilled)
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "the compiler was killed (out of memory) while compiling: ", file, "\n");
+        throw Y::Error(YERR_PROCESS_OOM_KILLED, "the compiler was killed by the OOM killer.");
+    }
+
+    i32 result = procResult.exitCode;
+    if(result != 0)
+    {
+        // terminated by --fail-fast (another job failed first).
+        if(AreProcessesCancelled())
+            throw Y::Error(YERR_BUILD_CANCELLED, "the build was cancelled.");
+
+        LLOG(RED_TEXT("[YMAKE COMPILE ERROR]: "), "failed to compile source file: ", file, "\n\t",
+             "exit code: ", result, "\n");
+        throw Y::Error(YERR_COMPILE_FAILED, "failed to compile source file.");
+    }
 
     LTRACE(true, "compiled file at: ", outPath, "\n");
 
     return Cache::ToAbsolutePath(outPath);
 }
 
-bool IsToolAvailable(const string &tool)
+// errors of the failed jobs of a build. (shared by the worker threads)
+struct BuildFailures
+{
+    std::mutex mut;
+    vector<string> files;
+    vector<string> errors;
+    std::atomic<bool> cancelled{false}; // no more jobs are started. (set under mut)
+
+    usize Count()
+    {
+        std::lock_guard<std::mutex> lock(mut);
+        return errors.size();
+    }
+};
+
+// records a failed job and applies the failure policy.
+//      STOP:       drop the queued jobs, let the running ones finish.
+//      FAIL_FAST:  drop the queued jobs, terminate the running ones.
+//      KEEP_GOING: keep going until N failures (if --keep-going=N).
+void OnJobFailed(BuildFailures &failures, ThreadPool &threadPool, const BuildOptions &options, const string &file,
+                 const string &error)
+{
+    bool cancel = false;
+    {
+        std::lock_guard<std::mutex> lock(failures.mut);
+        failures.files.push_back(file);
+        failures.errors.push_back(file + ": " + error);
+
+        if(options.onFailure != FailurePolicy::KEEP_GOING ||
+           (options.maxFailures != 0 && failures.errors.size() >= options.maxFailures))
+        {
+            cancel = !failures.cancelled.exchange(true);
+        }
+    }
+
+    if(!cancel)
+        return;
+
+    usize dropped = threadPool.Cancel();
+    if(dropped > 0)
+        LLOG(YELLOW_TEXT("[YMAKE BUILD]: "), "cancelled ", dropped, " queued job(s).\n");
+
+    if(options.onFailure == FailurePolicy::FAIL_FAST)
+        TerminateRunningProcesses();
+}
+
+usize GetJobCount(const BuildOptions &options)
+{
+    return (options.jobs != 0) ? options.jobs : GetMaxThreads();
+}
+
+// memory budget for the compile jobs of a project (in KB). 0 -> unlimited.
+u64 GetMemoryBudget(const Project &proj)
 {
-    string command = tool + " --version ";
-    command += COMP_SUPPRESS_OUTPUT;
-    int result = std::system(command.c_str());
-    return (result == 0); // 0 means success.
+    if(proj.memoryBudget != 0)
+        return proj.memoryBudget * 1024;
+
+    u64 physicalMemory = GetPhysicalMemoryMB();
+    return (physicalMemory * YMAKE_DEFAULT_MEMORY_BUDGET_PERCENT / 100) * 1024;
+}
+
+// predicted peak RSS (in KB) of compiling a file, based on previous builds.
+u64 PredictPeakRSS(const std::unordered_map<string, Cache::CompileStats> &history, const string &file)
+{
+    auto entry = history.find(file);
+    if(entry == history.end() || entry->second.peakRSS == 0)
+        return static_cast<u64>(YMAKE_DEFAULT_TU_PEAK_RSS_MB) * 1024;
+
+    // leave some headroom (~12%) for the file growing between builds.
+    return entry->second.peakRSS + entry->second.peakRSS / 8;
+}
+
+// re-runs compiles that were OOM-killed with less parallelism each round (the last round runs them alone).
+// the retries are admitted under the same memory budget as the first run. (predicted from compileHistory)
+// files that fail for other reasons are added to failures.
+void RetryOOMKilledFiles(Project &proj, vector<string> oomFiles, const string &cacheDir,
+                         const CompileTemplates &templates, usize jobs, vector<string> &compiledFiles,
+                         std::unordered_map<string, Cache::CompileStats> &compileStats,
+                         const std::unordered_map<string, Cache::CompileStats> &compileHistory,
+                         BuildFailures &failures, const BuildOptions &options, const ModuleBuild &modules)
+{
+    u64 memBudget = GetMemoryBudget(proj);
+
+    for(u32 round = 1; round <= YMAKE_OOM_RETRY_ROUNDS && !oomFiles.empty(); round++)
+    {
+        if(failures.cancelled)
+            return;
+
+        usize threads = (round == YMAKE_OOM_RETRY_ROUNDS) ? 1 : (jobs >> round);
+
+        LLOG(YELLOW_TEXT("[YMAKE BUILD]: "), "retrying ", oomFiles.size(), " OOM-killed file(s) with ",
+             (threads > 1 ? threads : 1), " job(s)...\n");
+
+        // from now on, these files are predicted to need the whole budget (so they run alone in future builds).
+        for(const auto &file : oomFiles)
+            compileStats[file] = Cache::CompileStats{memBudget, 0.0};
+
+        vector<string> stillKilled;
+        {
+            ThreadPool threadPool(threads);
+            threadPool.SetMemoryBudget(memBudget);
+            for(auto file : oomFiles)
+            {
+                threadPool.AddTask([&templates, file, cacheDir, &compiledFiles, &compileStats, &stillKilled,
+                                    &threadPool, &failures, &options, &modules] {
+                    ProcessResult procResult;
+                    try
+                    {
+                        string compiledFile = CompileFile(templates, file, cacheDir, procResult, modules);
+
+                        threadPool.Lock();
+                        compiledFiles.push_back(compiledFile);
+                        compileStats[file] = Cache::CompileStats{procResult.peakRSS, procResult.seconds};
+                        threadPool.Unlock();
+
+                        LLOG(GREEN_TEXT("[YMAKE BUILD]: "), "built file (after OOM retry): ", CYAN_TEXT(file), "\n");
+                    }
+                    catch(Y::Error &err)
+                    {
+                        if(err.GetErrNum() == YERR_BUILD_CANCELLED)
+                            return;
+
+                        if(err.GetErrNum() != YERR_PROCESS_OOM_KILLED)
+                        {
+                            OnJobFailed(failures, threadPool, options, file, err.what());
+                            return;
+                        }
+
+                        threadPool.Lock();
+                        stillKilled.push_back(file);
+                        threadPool.Unlock();
+                    }
+                }, PredictPeakRSS(compileHistory, file));
+            }
+
+            threadPool.JoinAll();
+        }
+
+        oomFiles = stillKilled;
+    }
+
+    for(const auto &file : oomFiles)
+    {
+        LLOG(RED_TEXT("[YMAKE COMPILE ERROR]: "), "the compiler ran out of memory compiling: ", file,
+             " (even when running alone)\n");
+
+        std::lock_guard<std::mutex> lock(failures.mut);
+        failures.files.push_back(file);
+        failures.errors.push_back(file + ": the compiler ran out of memory (even when running alone).");
+    }
+}
+
+// writes the translation units of a unity plan, returns what to compile. (the batches, then the isolated files)
+vector<string> GetUnityUnits(const UnityPlan &plan, const string &unityDir)
+{
+    vector<string> units;
+    for(usize i = 0; i < plan.batches.size(); i++)
+    {
+        if(plan.batches[i].empty())
+            continue;
+
+        string unityFile = GetUnityFilePath(unityDir, i, plan.batches[i]);
+        WriteUnityFile(unityFile, plan.batches[i]);
+        units.push_back(unityFile);
+    }
+
+    for(const auto &file : plan.isolated)
+        units.push_back(file);
+
+    return units;
+}
+
+vector<string> GetUnityExcludedFiles(const Project &proj)
+{
+    vector<string> excluded;
+    for(const auto &file : proj.unityExclude)
+        excluded.push_back(Cache::ToAbsolutePath(file));
+    return excluded;
 }
 
 string LinkStaticLibrary(Project &proj, Library &lib, vector<string> compiledFiles, const char *buildDir)
@@ -166,7 +688,7 @@ string LinkStaticLibrary(Project &proj, Library &lib, vector<string> compiledFil
 
     std::string libStaticExt = LIB_ST_EXT;
 
-    // ex: ar rcs libname.a file1.o file2.o file3.o
+    // ex: ar rcs libname.a file1.o file2.o file3.o (then: ar r libname.a file2.o && ar s libname.a)
     //      ex msvc: lib /OUT:libname.lib file1.obj file2.obj file3.obj
 
     // TODO: add support for other compilers.
@@ -174,25 +696,36 @@ string LinkStaticLibrary(Project &proj, Library &lib, vector<string> compiledFil
     // TODO: make vals like ar, llvm-ar, etc... configurable.
     // TODO: make constants defined in defines.h
 
-    if(IsToolAvailable("ar"))
+    // lto objects need an archiver with the compiler's plugin to index their symbols.
+    string archiver    = "ar";
+    string ltoArchiver = GetLTOArchiver(proj.lto, WhatCompiler(proj.cppCompiler.empty() ? proj.cCompiler
+                                                                                       : proj.cppCompiler));
+    if(!ltoArchiver.empty())
     {
-        string command = "ar rcs ";
+        if(IsToolAvailable(ltoArchiver))
+            archiver = ltoArchiver;
+        else
+            LLOG(YELLOW_TEXT("[YMAKE WARN]: "), ltoArchiver, " not found, the lto objects of: ", CYAN_TEXT(lib.name),
+                 " are packaged with ar.\n");
+    }
 
-        for(auto file : compiledFiles)
-            command += file + " ";
+    // the objects stay in YMakeCache, the archive is updated with the ones that changed.
+    string manifestPath =
+        string(YMAKE_CACHE_DIR) + "/" + proj.name + "/" + lib.name + "/" + YMAKE_ARCHIVE_CACHE_FILENAME;
 
+    if(IsToolAvailable(archiver))
+    {
         string outname = string(buildDir) + "/" + lib.name + libStaticExt;
-        command += outname + " ";
 
-        // suppress output.
-        command += COMP_SUPPRESS_OUTPUT;
-
-        LTRACE(true, "COMMAND TO LINK STATIC LIB: \n\t", command.c_str(), "\n");
-
-        // link the library.
-        i32 result = std::system(command.c_str());
-        LASSERT(result == 0, RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to link library: ", lib.name, "\n\t",
-                "exit code: ", result, "\n");
+        // package the library.
+        i32 result = UpdateStaticArchive(archiver, outname, compiledFiles, lib.thinArchive, manifestPath,
+                                         GetResponseFilePath(proj.name, lib.name + ".archive"));
+        if(result != 0)
+        {
+            LLOG(RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to link library: ", lib.name, "\n\t",
+                 "exit code: ", result, "\n");
+            throw Y::Error(YERR_LINK_FAILED, "failed to link a library.");
+        }
 
         LTRACE(true, "linked static library at: ", outname, "\n");
 
@@ -200,14 +733,14 @@ string LinkStaticLibrary(Project &proj, Library &lib, vector<string> compiledFil
     }
     else if(WhatCompiler(proj.cppCompiler) == Compiler::MSVC || WhatCompiler(proj.cCompiler) == Compiler::MSVC)
     {
-        // do msvc stuff.
+        // do msvc stuff. (lib has no thin archives, the library is always rewritten)
         string command = "lib /OUT:";
 
         string outname = string(buildDir) + "/" + lib.name + libStaticExt;
         command += outname + " ";
 
-        for(auto file : compiledFiles)
-            command += file + " ";
+        // objects. (in a response file if there are too many)
+        command += GetFileArgs(compiledFiles, GetResponseFilePath(proj.name, lib.name + ".archive"));
 
         // suppress output.
         command += COMP_MSVC_SUPPRESS_OUTPUT;
@@ -216,8 +749,12 @@ string LinkStaticLibrary(Project &proj, Library &lib, vector<string> compiledFil
 
         // link the library.
         i32 result = std::system(command.c_str());
-        LASSERT(result == 0, RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to link library: ", lib.name, "\n\t",
-                "exit code: ", result, "\n");
+        if(result != 0)
+        {
+            LLOG(RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to link library: ", lib.name, "\n\t",
+                 "exit code: ", result, "\n");
+            throw Y::Error(YERR_LINK_FAILED, "failed to link a library.");
+        }
 
         LTRACE(true, "linked static library at: ", outname, "\n");
 
@@ -226,23 +763,17 @@ string LinkStaticLibrary(Project &proj, Library &lib, vector<string> compiledFil
     else if((WhatCompiler(proj.cppCompiler) == Compiler::CLANG || WhatCompiler(proj.cCompiler) == Compiler::CLANG) &&
             IsToolAvailable("llvm-ar"))
     {
-        string command = "llvm-ar rcs ";
-
         string outname = string(buildDir) + "/" + lib.name + libStaticExt;
-        command += outname;
-
-        for(auto file : compiledFiles)
-            command += file + " ";
-
-        // suppress output.
-        command += COMP_SUPPRESS_OUTPUT;
 
-        LTRACE(true, "COMMAND TO LINK STATIC LIB: \n\t", command.c_str(), "\n");
-
-        // link the library.
-        i32 result = std::system(command.c_str());
-        LASSERT(result == 0, RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to link library: ", lib.name, "\n\t",
-                "exit code: ", result, "\n");
+        // package the library.
+        i32 result = UpdateStaticArchive("llvm-ar", outname, compiledFiles, lib.thinArchive, manifestPath,
+                                         GetResponseFilePath(proj.name, lib.name + ".archive"));
+        if(result != 0)
+        {
+            LLOG(RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to link library: ", lib.name, "\n\t",
+                 "exit code: ", result, "\n");
+            throw Y::Error(YERR_LINK_FAILED, "failed to link a library.");
+        }
 
         LTRACE(true, "linked static library at: ", outname, "\n");
 
@@ -257,7 +788,7 @@ string LinkStaticLibrary(Project &proj, Library &lib, vector<string> compiledFil
 }
 
 // string builtLib = LinkLibrary(Project, lib, compiledFiles, buildDir);
-string LinkDynamicLibrary(Project &proj, Library &lib, vector<string> compiledFiles, const char *buildDir)
+string LinkDynamicLibrary(Project &proj, Library &lib, vector<string> compiledFiles, const char *buildDir, usize jobs)
 {
     LTRACE(true, "linking shared library: ", lib.name, "...\n");
 
@@ -297,36 +828,56 @@ string LinkDynamicLibrary(Project &proj, Library &lib, vector<string> compiledFi
         throw Y::Error("no compiler specified in the project config file.");
     }
 
+    const Toolchain &toolchain = GetToolchain(compiler);
+
     // add -shared flag.
-    command += (compiler == Compiler::MSVC) ? COMP_MSVC_BUILD_SHARED_LIBRARY : COMP_BUILD_SHARED_LIBRARY;
+    command += toolchain.sharedLibrary;
 
-    // add files to link.
-    for(auto file : compiledFiles)
-        command += file + " ";
+    // pick the linker.
+    string linker = ResolveLinker(proj.linker, compiler, command.substr(0, command.find(' ')));
+    command += GetLinkerFlags(linker, jobs);
+
+    // libraries are always built in release mode. (with lto if it's on)
+    command += GetLTOLinkFlags(proj.lto, compiler, linker, jobs,
+                               Cache::ToAbsolutePath(string(YMAKE_CACHE_DIR) + "/" + proj.name + "/" + YMAKE_LTO_DIR));
+    command += GetPGOFlags(proj.pgo, compiler, GetPGODir(proj.name));
+    command += GetLinkPresetFlags(proj.linkPreset, compiler);
+
+    // exported symbols.
+    command += GetExportFlags(lib.exports, lib.versionScript, compiler,
+                              string(YMAKE_CACHE_DIR) + "/" + proj.name + "/" + lib.name + "/" +
+                                  YMAKE_EXPORTS_MAP_FILENAME);
+
+    // add files to link. (in a response file if there are too many)
+    command += GetFileArgs(compiledFiles, GetResponseFilePath(proj.name, lib.name + ".shared"));
 
     // add linker flags. NOTE: always use release flags for libraries.
     for(auto flag : proj.flagsRelease)
         command += flag + " ";
 
     // add system libraries.
-    for(auto sysLib : proj.sysLibs)
-        command += (compiler == Compiler::MSVC) ? COMP_MSVC_LINK_LIBRARY(sysLib) : COMP_LINK_LIBRARY(sysLib);
+    for(const auto &sysLib : proj.sysLibs)
+        Toolchain::Append(command, toolchain.linkLibrary, sysLib);
 
     // add prebuilt libraries.
-    for(auto prebuiltLib : proj.preBuiltLibs)
-        command += (compiler == Compiler::MSVC) ? COMP_MSVC_LINK_LIBRARY(prebuiltLib) : COMP_LINK_LIBRARY(prebuiltLib);
+    for(const auto &prebuiltLib : proj.preBuiltLibs)
+        Toolchain::Append(command, toolchain.linkLibrary, prebuiltLib);
 
     // add output file.
     const string outname = string(buildDir) + "/" + lib.name + libDynamicExt;
     LTRACE(true, "OUTNAME: ", outname, "\n------------------------------------------\n");
-    command += (compiler == Compiler::MSVC) ? COMP_MSVC_OUTPUT_FILE(outname) : COMP_OUTPUT_FILE(outname);
+    Toolchain::Append(command, toolchain.output, outname);
 
     LTRACE(true, "COMMAND TO LINK SHARED LIB: \n\t", command.c_str(), "\n");
 
     // link the library.
-    i32 result = std::system(command.c_str());
-    LASSERT(result == 0, RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to link library: ", lib.name, "\n\t",
-            "exit code: ", result, "\n");
+    i32 result = RunProcess(command).exitCode;
+    if(result != 0)
+    {
+        LLOG(RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to link library: ", lib.name, "\n\t",
+             "exit code: ", result, "\n");
+        throw Y::Error(YERR_LINK_FAILED, "failed to link a library.");
+    }
 
     if(!onWindows)
         return outname;
@@ -359,8 +910,12 @@ string LinkDynamicLibrary(Project &proj, Library &lib, vector<string> compiledFi
         string defCommand = "gendef " + outname;
 
         result = std::system(defCommand.c_str());
-        LASSERT(result == 0, RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to generate .def file for: ", lib.name, "\n\t",
-                "exit code: ", result, "\n");
+        if(result != 0)
+        {
+            LLOG(RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to generate .def file for: ", lib.name, "\n\t",
+                 "exit code: ", result, "\n");
+            throw Y::Error(YERR_LINK_FAILED, "failed to generate a .def file.");
+        }
     }
 
     if(!fs::exists(defFile) && dumpbinAvailable)
@@ -368,16 +923,24 @@ string LinkDynamicLibrary(Project &proj, Library &lib, vector<string> compiledFi
         string defCommand = "dumpbin /exports " + outname + " > " + defFile;
 
         result = std::system(defCommand.c_str());
-        LASSERT(result == 0, RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to generate .def file for: ", lib.name, "\n\t",
-                "exit code: ", result, "\n");
+        if(result != 0)
+        {
+            LLOG(RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to generate .def file for: ", lib.name, "\n\t",
+                 "exit code: ", result, "\n");
+            throw Y::Error(YERR_LINK_FAILED, "failed to generate a .def file.");
+        }
     }
     else if(!fs::exists(defFile) && pexportsAvailable)
     {
         string defCommand = "pexports " + outname + " > " + defFile;
 
         result = std::system(defCommand.c_str());
-        LASSERT(result == 0, RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to generate .def file for: ", lib.name, "\n\t",
-                "exit code: ", result, "\n");
+        if(result != 0)
+        {
+            LLOG(RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to generate .def file for: ", lib.name, "\n\t",
+                 "exit code: ", result, "\n");
+            throw Y::Error(YERR_LINK_FAILED, "failed to generate a .def file.");
+        }
     }
     else if(!fs::exists(defFile))
     {
@@ -394,15 +957,23 @@ string LinkDynamicLibrary(Project &proj, Library &lib, vector<string> compiledFi
     {
         string libCommand = "dlltool -d " + defFile + " -l " + Basepath(outname) + "/" + lib.name + ".lib";
         result            = std::system(libCommand.c_str());
-        LASSERT(result == 0, RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to generate .lib file for: ", lib.name, "\n\t",
-                "exit code: ", result, "\n");
+        if(result != 0)
+        {
+            LLOG(RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to generate .lib file for: ", lib.name, "\n\t",
+                 "exit code: ", result, "\n");
+            throw Y::Error(YERR_LINK_FAILED, "failed to generate a .lib file.");
+        }
     }
     else if(msvcAvailable)
     {
         string libCommand = "lib /DEF:" + defFile + " /OUT:" + outname.substr(0, outname.find_last_of('.')) + ".lib";
         result            = std::system(libCommand.c_str());
-        LASSERT(result == 0, RED_TEXT("[YMAKE LINKER ERROR]: "),
-                "failed to generate .lib file using MSVC for: ", lib.name, "\n\t", "exit code: ", result, "\n");
+        if(result != 0)
+        {
+            LLOG(RED_TEXT("[YMAKE LINKER ERROR]: "),
+                 "failed to generate .lib file using MSVC for: ", lib.name, "\n\t", "exit code: ", result, "\n");
+            throw Y::Error(YERR_LINK_FAILED, "failed to generate a .lib file.");
+        }
     }
     else if(gccAvailable)
     {
@@ -410,8 +981,12 @@ string LinkDynamicLibrary(Project &proj, Library &lib, vector<string> compiledFi
         string libCommand = "gcc -shared -o " + outname + " " + outname.substr(0, outname.find_last_of('.')) +
                             ".o -Wl,--out-implib," + outname.substr(0, outname.find_last_of('.')) + ".lib";
         result = std::system(libCommand.c_str());
-        LASSERT(result == 0, RED_TEXT("[YMAKE LINKER ERROR]: "),
-                "failed to generate .lib file using GCC for: ", lib.name, "\n\t", "exit code: ", result, "\n");
+        if(result != 0)
+        {
+            LLOG(RED_TEXT("[YMAKE LINKER ERROR]: "),
+                 "failed to generate .lib file using GCC for: ", lib.name, "\n\t", "exit code: ", result, "\n");
+            throw Y::Error(YERR_LINK_FAILED, "failed to generate a .lib file.");
+        }
     }
     else if(llvmArAvailable)
     {
@@ -419,8 +994,12 @@ string LinkDynamicLibrary(Project &proj, Library &lib, vector<string> compiledFi
         string libCommand = "llvm-ar rcs " + outname.substr(0, outname.find_last_of('.')) + ".lib " +
                             outname.substr(0, outname.find_last_of('.')) + ".o";
         result = std::system(libCommand.c_str());
-        LASSERT(result == 0, RED_TEXT("[YMAKE LINKER ERROR]: "),
-                "failed to generate .lib file using LLVM for: ", lib.name, "\n\t", "exit code: ", result, "\n");
+        if(result != 0)
+        {
+            LLOG(RED_TEXT("[YMAKE LINKER ERROR]: "),
+                 "failed to generate .lib file using LLVM for: ", lib.name, "\n\t", "exit code: ", result, "\n");
+            throw Y::Error(YERR_LINK_FAILED, "failed to generate a .lib file.");
+        }
     }
     else
     {
@@ -469,7 +1048,7 @@ string LinkDynamicLibrary(Project &proj, Library &lib, vector<string> compiledFi
 }
 
 Library BuildLibrary(Project &proj, Library &lib, const char *buildDir, f32 libPercent, f32 &currentPercent,
-                     bool CLEAN_BUILD = false)
+                     const BuildOptions &options, bool CLEAN_BUILD = false)
 {
     LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "building library: ", CYAN_TEXT(lib.name), "...\n");
 
@@ -479,35 +1058,90 @@ Library BuildLibrary(Project &proj, Library &lib, const char *buildDir, f32 libP
         throw Y::Error("library path is empty.");
     }
 
+    vector<string> files = Cache::GetSrcFilesRecursive(lib.path);
+
+    // get directory for .o files.
+    string projCacheDir = string(YMAKE_CACHE_DIR) + "/" + proj.name;
+    if(!Cache::DirExists(projCacheDir.c_str()))
+        Cache::CreateDir(projCacheDir.c_str());
+
+    string cacheDir = string(projCacheDir) + "/" + lib.name + "";
+    Cache::CreateDir(cacheDir.c_str());
+
+    // compile history (for memory admission control and unity batches)
+    auto compileHistory = Cache::LoadCompileStatsCache(projCacheDir.c_str());
+    std::unordered_map<string, Cache::CompileStats> compileStats;
+
+    // a dual library is compiled once, position independent (like a shared library).
+    BuildType compileType = lib.dual ? BuildType::SHARED_LIB : lib.type;
+
+    // the library's files are compiled with its own visibility.
+    Project libProj    = proj;
+    libProj.visibility = lib.visibility;
+
+    // precompiled header. (before the files are grouped in unity batches)
+    // NOTE: the library is rebuilt entirely when the pch was rebuilt.
+    bool pchRebuilt = false;
+    PCH pch = PreparePCH(libProj, lib.pch, files, lib.name, BuildMode::RELEASE, compileType, false, pchRebuilt);
+
+    // always compile library files in release mode.
+    CompileTemplates templates = MakeCompileTemplates(libProj, BuildMode::RELEASE, compileType, false, pch);
+
+    // NOTE: library sources aren't scanned for modules. (only the project's sources are)
+    ModuleBuild modules;
+
     // if not clean build ->
-    // check if the built dll/lib exists in the build directory.
+    // check if the built dll/lib exists in the build directory, and that no source would be compiled with another
+    // command now. (flags, defines, compiler, ...)
     // if not rebuild it, else return it.
-
+    auto commandKeys = Cache::LoadObjectCommandsCache(cacheDir);
+    MigrateLegacyObjects(templates, files, cacheDir, modules, commandKeys);
     if(!CLEAN_BUILD)
     {
         string libPath =
             string(buildDir) + "/" + lib.name + ((lib.type == BuildType::SHARED_LIB) ? LIB_DYN_EXT : LIB_ST_EXT);
 
-        if(Cache::FileExists(libPath.c_str()))
+        // (and the other type of a dual library)
+        string otherPath =
+            string(buildDir) + "/" + lib.name + ((lib.type == BuildType::SHARED_LIB) ? LIB_ST_EXT : LIB_DYN_EXT);
+
+        bool commandsChanged = std::any_of(files.begin(), files.end(), [&](const string &file) {
+            return IsObjectCommandStale(templates, file, cacheDir, modules, commandKeys);
+        });
+
+        if(Cache::FileExists(libPath.c_str()) && (!lib.dual || Cache::FileExists(otherPath.c_str())) &&
+           !commandsChanged && !pchRebuilt)
         {
             Library compiled;
             compiled.name    = lib.name;
             compiled.path    = libPath;
             compiled.type    = lib.type;
             compiled.include = lib.include;
+            compiled.dual    = lib.dual;
             return compiled;
         }
     }
 
-    vector<string> files = Cache::GetSrcFilesRecursive(lib.path);
-
-    // get directory for .o files.
-    string projCacheDir = string(YMAKE_CACHE_DIR) + "/" + proj.name;
-    if(!Cache::DirExists(projCacheDir.c_str()))
-        Cache::CreateDir(projCacheDir.c_str());
+    // the keys of the sources. (a unity build compiles them in batches, with the same flags)
+    Cache::PathMap<string> sourceKeys;
+    sourceKeys.Reserve(files.size());
+    for(const auto &file : files)
+    {
+        string object;
+        string key = GetObjectCommandKey(templates, file, cacheDir, modules, object);
+        if(!key.empty())
+            sourceKeys[Cache::InternPath(object)] = key;
+    }
 
-    string cacheDir = string(projCacheDir) + "/" + lib.name + "";
-    Cache::CreateDir(cacheDir.c_str());
+    // unity build: libraries are always built entirely, so the batches are planned every time.
+    UnityPlan unityPlan;
+    string unityDir = Cache::ToAbsolutePath(projCacheDir + "/" + YMAKE_UNITY_DIR + "/" + lib.name);
+    if(proj.unity)
+    {
+        Cache::CreateDir(unityDir.c_str());
+        unityPlan = PlanUnityBatches(files, GetUnityExcludedFiles(proj), compileHistory, GetJobCount(options));
+        files     = GetUnityUnits(unityPlan, unityDir);
+    }
 
     // percentage calculation.
     f32 filePercent_f = 100.0f / files.size();
@@ -518,64 +1152,160 @@ Library BuildLibrary(Project &proj, Library &lib, const char *buildDir, f32 libP
     i32 percent = currentPercent;
 
     // create a thread pool...
-    ThreadPool threadPool;
+    ThreadPool threadPool(GetJobCount(options));
+    threadPool.SetMemoryBudget(GetMemoryBudget(proj));
+    JobTuner jobTuner(threadPool, options.autoJobs);
+
     vector<string> compiledFiles;
+    vector<string> oomFiles;
+    BuildFailures failures;
     for(auto file : files)
     {
-        threadPool.AddTask([&proj, file, cacheDir, &compiledFiles, &percent, filePercent, filePercent_decimal,
-                            &threadPool, &lib] {
+        u64 memCost = PredictPeakRSS(compileHistory, file);
+
+        threadPool.AddTask(
+            [&templates, file, cacheDir, &compiledFiles, &compileStats, &oomFiles, &percent, filePercent,
+             filePercent_decimal, &threadPool, &failures, &options, &modules] {
+                ProcessResult procResult;
+                try
+                {
+                    string compiledFile = CompileFile(templates, file, cacheDir, procResult, modules);
+                    LTRACE(true, "compiled file at: ", compiledFile, "\n");
+
+                    threadPool.Lock();
+                    compiledFiles.push_back(compiledFile);
+                    compileStats[file] = Cache::CompileStats{procResult.peakRSS, procResult.seconds};
+                    threadPool.Unlock();
+                }
+                catch(Y::Error &err)
+                {
+                    if(err.GetErrNum() == YERR_PROCESS_OOM_KILLED)
+                    {
+                        // re-queued after the other jobs are done.
+                        threadPool.Lock();
+                        oomFiles.push_back(file);
+                        threadPool.Unlock();
+                        return;
+                    }
+
+                    if(err.GetErrNum() == YERR_BUILD_CANCELLED)
+                        return;
+
+                    LLOG(RED_TEXT("[YMAKE BUILD]: "), "error building file: ", CYAN_TEXT(file), "\n\t", err.what(),
+                         "\n");
+                    OnJobFailed(failures, threadPool, options, file, err.what());
+                    return;
+                }
+
+                threadPool.Lock();
+                percent += filePercent + filePercent_decimal;
+                if(percent >= 99.0f)
+                    percent = 100.0f;
+
+                if(filePercent_decimal > 0)
+                {
+                    LLOG(GREEN_TEXT("[YMAKE BUILD]: "), BLUE_TEXT("[", (i32)percent, ".", filePercent_decimal, "%] "),
+                         "built file: ", CYAN_TEXT(file), "\n");
+                }
+                else
+                {
+                    LLOG(GREEN_TEXT("[YMAKE BUILD]: "), BLUE_TEXT("[", (i32)percent, "%] "),
+                         "built file: ", CYAN_TEXT(file), "\n");
+                }
+
+                threadPool.Unlock();
+            },
+            memCost);
+    }
+
+    threadPool.JoinAll();
+
+    if(!oomFiles.empty())
+        RetryOOMKilledFiles(proj, oomFiles, cacheDir, templates, GetJobCount(options), compiledFiles, compileStats,
+                            compileHistory, failures, options, modules);
+
+    if(proj.unity)
+        AttributeUnityStats(unityPlan, unityDir, compileHistory, compileStats);
+
+    for(auto &[file, stats] : compileStats)
+        compileHistory[file] = stats;
+    Cache::SaveCompileStatsCache(projCacheDir.c_str(), compileHistory);
+
+    // don't link a library with missing objects.
+    if(failures.Count() > 0 || AreProcessesCancelled())
+    {
+        for(const auto &error : failures.errors)
+            LLOG(RED_TEXT("[YMAKE BUILD ERROR]: "), error, "\n");
+        throw Y::Error(YERR_BUILD_FAILED, "some library files failed to compile.");
+    }
+
+    // a dual library is packaged as both from the same objects.
+    bool packStatic = (lib.type == BuildType::STATIC_LIB) || lib.dual;
+    bool packShared = (lib.type == BuildType::SHARED_LIB) || lib.dual;
+
+    // pre-link the objects of a static library, the final link gets one input.
+    vector<string> archivedFiles = compiledFiles;
+    if(packStatic && !lib.prelink.empty())
+    {
+        string executable = proj.cppCompiler.empty() ? proj.cCompiler : proj.cppCompiler;
+        archivedFiles = PrelinkObjects(lib.prelink, WhatCompiler(executable), executable, !proj.lto.empty(),
+                                       compiledFiles, cacheDir + "/" + lib.name + ".prelink.o",
+                                       GetResponseFilePath(proj.name, lib.name + ".prelink"));
+    }
+    else if(!lib.prelink.empty())
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "prelink only applies to static libraries, ignoring it for: ",
+             CYAN_TEXT(lib.name), "\n");
+
+    // link everything. (both at once for a dual library, if the job budget allows it)
+    // (a failed link is rethrown once both are done, the failure policy of the build applies)
+    string staticLib, sharedLib;
+    std::atomic<bool> linkFailed{false};
+    ThreadPool linkPool((packStatic && packShared) ? std::min<usize>(2, GetJobCount(options)) : 1);
+    if(packStatic)
+    {
+        linkPool.AddTask([&proj, &lib, &archivedFiles, buildDir, &staticLib, &linkFailed] {
             try
             {
-                // always compile library files in release mode.
-                string compiledFile =
-                    CompileFile(proj, file.c_str(), cacheDir.c_str(), BuildMode::RELEASE, lib.type, false);
-                LTRACE(true, "compiled file at: ", compiledFile, "\n");
-
-                compiledFiles.push_back(compiledFile);
+                staticLib = LinkStaticLibrary(proj, lib, archivedFiles, buildDir);
             }
             catch(Y::Error &err)
             {
-                LLOG(RED_TEXT("[YMAKE BUILD]: "), "error building file: ", CYAN_TEXT(file), "\n\t", err.what(), "\n");
+                LLOG(RED_TEXT("[YMAKE BUILD]: "), "error linking library: ", CYAN_TEXT(lib.name), "\n\t", err.what(),
+                     "\n");
+                linkFailed = true;
             }
-
-            threadPool.Lock();
-            percent += filePercent + filePercent_decimal;
-            if(percent >= 99.0f)
-                percent = 100.0f;
-
-            if(filePercent_decimal > 0)
+        });
+    }
+    if(packShared)
+    {
+        linkPool.AddTask([&proj, &lib, &compiledFiles, buildDir, &sharedLib, &options, &linkFailed] {
+            try
             {
-                LLOG(GREEN_TEXT("[YMAKE BUILD]: "), BLUE_TEXT("[", (i32)percent, ".", filePercent_decimal, "%] "),
-                     "built file: ", CYAN_TEXT(file), "\n");
+                sharedLib = LinkDynamicLibrary(proj, lib, compiledFiles, buildDir, GetJobCount(options));
             }
-            else
+            catch(Y::Error &err)
             {
-                LLOG(GREEN_TEXT("[YMAKE BUILD]: "), BLUE_TEXT("[", (i32)percent, "%] "),
-                     "built file: ", CYAN_TEXT(file), "\n");
+                LLOG(RED_TEXT("[YMAKE BUILD]: "), "error linking library: ", CYAN_TEXT(lib.name), "\n\t", err.what(),
+                     "\n");
+                linkFailed = true;
             }
-
-            threadPool.Unlock();
         });
     }
+    linkPool.JoinAll();
 
-    threadPool.JoinAll();
+    if(linkFailed)
+        throw Y::Error(YERR_LINK_FAILED, "failed to link a library.");
 
-    // link everything.
-    string builtLib;
-    try
+    if(!packStatic && !packShared)
     {
-        if(lib.type == BuildType::STATIC_LIB)
-            builtLib = LinkStaticLibrary(proj, lib, compiledFiles, buildDir);
-        else if(lib.type == BuildType::SHARED_LIB)
-            builtLib = LinkDynamicLibrary(proj, lib, compiledFiles, buildDir);
-        else
-            throw Y::Error("unknown library type.");
-    }
-    catch(Y::Error &err)
-    {
-        LLOG(RED_TEXT("[YMAKE BUILD]: "), "error linking library: ", CYAN_TEXT(lib.name), "\n\t", err.what(), "\n");
+        LLOG(RED_TEXT("[YMAKE BUILD]: "), "error linking library: ", CYAN_TEXT(lib.name), "\n\t",
+             "unknown library type.\n");
+        throw Y::Error(YERR_LINK_FAILED, "unknown library type.");
     }
 
+    // the project links with the first type.
+    string builtLib = (lib.type == BuildType::SHARED_LIB) ? sharedLib : staticLib;
+
     // building library is done!
     LLOG(GREEN_TEXT("[YMAKE BUILD]: "), BLUE_TEXT("[", percent, "%] "), "built library: ", CYAN_TEXT(lib.name), "\n");
 
@@ -588,14 +1318,18 @@ Library BuildLibrary(Project &proj, Library &lib, const char *buildDir, f32 libP
     LTRACE(true, "COMPILED LIBRARY AT: ", builtLib, "\n---------------------------------------\n");
     compLib.type    = lib.type;
     compLib.include = lib.include;
+    compLib.dual    = lib.dual;
 
     LTRACE(true, "library built at: ", builtLib, "\n");
 
+    Cache::SaveObjectCommandsCache(cacheDir, sourceKeys);
+
     return compLib;
 }
 
-// LinkEverything(proj, compiledFiles, compiledLibs);
-string LinkEverything(Project &proj, vector<string> compiledFiles, vector<Library> compiledLibs, BuildMode mode)
+// LinkEverything(proj, compiledFiles, compiledLibs, mode, jobs);
+string LinkEverything(Project &proj, vector<string> compiledFiles, vector<Library> compiledLibs, BuildMode mode,
+                      usize jobs)
 {
     // LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "linking project: ", CYAN_TEXT(proj.name), "...\n");
 
@@ -621,9 +1355,31 @@ string LinkEverything(Project &proj, vector<string> compiledFiles, vector<Librar
         throw Y::Error("no compiler specified in the project config file.");
     }
 
-    // add files to link.
-    for(auto file : compiledFiles)
-        command += file + " ";
+    const Toolchain &toolchain = GetToolchain(compiler);
+
+    // pick the linker.
+    string linker = ResolveLinker(proj.linker, compiler, command.substr(0, command.find(' ')));
+    command += GetLinkerFlags(linker, jobs);
+
+    // NOTE: the lto link flags are added in debug too, the (release) libraries might hold lto objects.
+    // they don't change anything for regular objects.
+    command += GetLTOLinkFlags(proj.lto, compiler, linker, jobs,
+                               Cache::ToAbsolutePath(string(YMAKE_CACHE_DIR) + "/" + proj.name + "/" + YMAKE_LTO_DIR));
+    command += GetPGOFlags(proj.pgo, compiler, GetPGODir(proj.name));
+
+    // post-link optimization. (release executables)
+    if(mode == BuildMode::RELEASE && proj.buildType == BuildType::EXECUTABLE)
+        command += GetPostLinkFlags(proj.postLink, linker, GetPostLinkDir(proj.name));
+
+    if(mode == BuildMode::RELEASE)
+        command += GetLinkPresetFlags(proj.linkPreset, compiler);
+
+    // compressed debug info.
+    if(mode == BuildMode::DEBUG)
+        command += GetDebugInfoLinkFlags(proj.compressDebug, compiler, command.substr(0, command.find(' ')));
+
+    // add files to link. (in a response file if there are too many)
+    command += GetFileArgs(compiledFiles, GetResponseFilePath(proj.name, proj.name + ".link"));
 
     // add linker flags.
     if(mode == BuildMode::RELEASE)
@@ -638,28 +1394,35 @@ string LinkEverything(Project &proj, vector<string> compiledFiles, vector<Librar
     }
 
     // add includes.
-    for(auto inclDir : proj.includeDirs)
-        command +=
-            (compiler == Compiler::MSVC) ? COMP_MSVC_INCLUDE_DIR(inclDir.c_str()) : COMP_INCLUDE_DIR(inclDir.c_str());
+    for(const auto &inclDir : proj.includeDirs)
+        Toolchain::Append(command, toolchain.includeDir, inclDir);
 
     // add libraries.
-    for(auto lib : compiledLibs)
+    for(const auto &lib : compiledLibs)
     {
-        command += (compiler == Compiler::MSVC) ? COMP_MSVC_INCLUDE_DIR(lib.include) : COMP_INCLUDE_DIR(lib.include);
-        command += (compiler == Compiler::MSVC) ? COMP_MSVC_LIBRARY_DIR(Basepath(lib.path))
-                                                : COMP_LIBRARY_DIR(Basepath(lib.path));
+        Toolchain::Append(command, toolchain.includeDir, lib.include);
+
+        // a static or dual library is linked by its path, with -l the linker would pick the shared library of a dual
+        // one. (the first listed type is the one linked)
+        if(lib.type == BuildType::STATIC_LIB || lib.dual)
+        {
+            command += lib.path + " ";
+            continue;
+        }
+
+        Toolchain::Append(command, toolchain.libraryDir, Basepath(lib.path));
 
         // NOTE: could use Basename(lib.path) instead of lib.name
-        command += (compiler == Compiler::MSVC) ? COMP_MSVC_LINK_LIBRARY(lib.name) : COMP_LINK_LIBRARY(lib.name);
+        Toolchain::Append(command, toolchain.linkLibrary, lib.name);
     }
 
     // add system libraries.
-    for(auto sysLib : proj.sysLibs)
-        command += (compiler == Compiler::MSVC) ? COMP_MSVC_LINK_LIBRARY(sysLib) : COMP_LINK_LIBRARY(sysLib);
+    for(const auto &sysLib : proj.sysLibs)
+        Toolchain::Append(command, toolchain.linkLibrary, sysLib);
 
     // add prebuilt libraries.
-    for(auto prebuiltLib : proj.preBuiltLibs)
-        command += (compiler == Compiler::MSVC) ? COMP_MSVC_LINK_LIBRARY(prebuiltLib) : COMP_LINK_LIBRARY(prebuiltLib);
+    for(const auto &prebuiltLib : proj.preBuiltLibs)
+        Toolchain::Append(command, toolchain.linkLibrary, prebuiltLib);
 
         // add output file.
 
@@ -707,25 +1470,27 @@ string LinkEverything(Project &proj, vector<string> compiledFiles, vector<Librar
     if(proj.buildType == BuildType::EXECUTABLE)
     {
         outname = string(proj.buildDir) + "/" + proj.name + libExecutableExt;
-        command += (compiler == Compiler::MSVC) ? COMP_MSVC_OUTPUT_FILE(outname) : COMP_OUTPUT_FILE(outname);
+        Toolchain::Append(command, toolchain.output, outname);
     }
     else if(proj.buildType == BuildType::STATIC_LIB)
     {
         outname = string(proj.buildDir) + "/" + proj.name + libStaticExt;
-        command += (compiler == Compiler::MSVC) ? COMP_MSVC_OUTPUT_FILE(outname) : COMP_OUTPUT_FILE(outname);
+        Toolchain::Append(command, toolchain.output, outname);
     }
     else if(proj.buildType == BuildType::SHARED_LIB)
     {
         outname = string(proj.buildDir) + "/" + proj.name + libDynamicExt;
-        command += (compiler == Compiler::MSVC) ? COMP_MSVC_OUTPUT_FILE(outname) : COMP_OUTPUT_FILE(outname);
+        Toolchain::Append(command, toolchain.output, outname);
     }
 
     LTRACE(true, "COMMAND TO LINK ALL: \n\t", command.c_str(), "\n");
 
     // link the project.
-    i32 result = std::system(command.c_str());
-    LASSERT(result == 0, RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to link project: ", proj.name, "\n\t",
-            "exit code: ", result, "\n");
+    ProcessResult result = RunProcess(command);
+    LASSERT(result.exitCode == 0, RED_TEXT("[YMAKE LINKER ERROR]: "), "failed to link project: ", proj.name, "\n\t",
+            "exit code: ", result.exitCode, "\n");
+
+    RecordLinkTime(string(YMAKE_CACHE_DIR) + "/" + proj.name, linker, result.seconds);
 
     LTRACE(true, "linked project at: ", proj.buildDir, "\n");
 
@@ -735,15 +1500,18 @@ string LinkEverything(Project &proj, vector<string> compiledFiles, vector<Librar
     return outname;
 }
 
-bool NeedsRecompiling(const Project &proj, const string &filePath)
+// sourceChanged (optional): set to true if the file itself changed. (not just something it includes)
+bool NeedsRecompiling(const Project &proj, const string &filePath, bool *sourceChanged = nullptr)
 {
     string cacheDir = string(YMAKE_CACHE_DIR) + "/" + proj.name;
 
-    string filepath = Cache::ToAbsolutePath(filePath);
+    // (normalized once per path)
+    Cache::PathId fileId = Cache::InternPath(filePath);
+    string filepath      = Cache::GetInternedPath(fileId);
     LTRACE(true, "checking if file \'", filepath, "\' needs re-compiling...\n");
 
     // load cache.
-    std::unordered_map<string, Cache::FileMetadata> cacheReg;
+    Cache::PathMap<Cache::FileMetadata> cacheReg;
     try
     {
         cacheReg = Cache::LoadMetadataCache(string(cacheDir.c_str()) + "/" + YMAKE_METADATA_CACHE_FILENAME);
@@ -755,16 +1523,19 @@ bool NeedsRecompiling(const Project &proj, const string &filePath)
     }
 
     LTRACE(true, "files found in metadata.cache for proj: ", proj.name, ", are: \n");
-    for(auto &[k, v] : cacheReg)
-    {
-        LTRACE(true, "entry => k: ", k, "\tv: ", v.fileSize, "\n");
-    }
+    cacheReg.ForEach([](Cache::PathId k, const Cache::FileMetadata &v) {
+        LTRACE(true, "entry => k: ", Cache::GetInternedPath(k), "\tv: ", v.fileSize, "\n");
+    });
 
     // if file doesn't exist in cache reg -> recompile
-    if(cacheReg.count(filepath) == 0)
+    const Cache::FileMetadata *cached = cacheReg.Find(fileId);
+    if(cached == nullptr)
     {
         // update cache.
         LTRACE(true, "file is not in the cache registry -> it needs recompiling.\n");
+        if(sourceChanged)
+            *sourceChanged = true;
+
         Cache::UpdateMetadataCache(filepath, cacheDir.c_str());
 
         string preFile = Cache::PreprocessUnit(proj, filepath, cacheDir.c_str());
@@ -773,9 +1544,12 @@ bool NeedsRecompiling(const Project &proj, const string &filePath)
         return true; // it needs recompiling.
     }
 
-    if(cacheReg[filepath.c_str()].fileSize != Cache::GetFileSize(filepath.c_str()))
+    if(cached->fileSize != Cache::GetFileSize(filepath.c_str()))
     {
         LTRACE(true, "file is in the cache registry. and file size has changed. recompiling.\n");
+        if(sourceChanged)
+            *sourceChanged = true;
+
         Cache::UpdateMetadataCache(filepath, cacheDir.c_str());
 
         string preFile = Cache::PreprocessUnit(proj, filepath, cacheDir.c_str());
@@ -783,9 +1557,12 @@ bool NeedsRecompiling(const Project &proj, const string &filePath)
 
         return true; // it needs recompiling.
     }
-    if(cacheReg[filepath.c_str()].lastWriteTime != Cache::GetTimeSinceLastWrite(filepath.c_str()))
+    if(cached->lastWriteTime != Cache::GetTimeSinceLastWrite(filepath.c_str()))
     {
         LTRACE(true, "file is in the cache registry. and file has been modified. recompiling.\n");
+        if(sourceChanged)
+            *sourceChanged = true;
+
         Cache::UpdateMetadataCache(filepath, cacheDir.c_str());
 
         string preFile = Cache::PreprocessUnit(proj, filepath, cacheDir.c_str());
@@ -795,15 +1572,16 @@ bool NeedsRecompiling(const Project &proj, const string &filePath)
     }
 
     // TODO: preprocessed metadata cache.a
-    auto preCache = Cache::LoadPreprocessedCache(cacheDir.c_str());
-    if(preCache.count(filePath) == 0)
+    auto preCache        = Cache::LoadPreprocessedCache(cacheDir.c_str());
+    const u64 *preCached = preCache.Find(fileId);
+    if(preCached == nullptr)
     {
         Cache::UpdatePreprocessedCache(filePath, cacheDir.c_str());
         return true; // it needs recompiling.
     }
     else
     {
-        if(preCache[filePath] != Cache::GetFileSize(filePath.c_str()))
+        if(*preCached != Cache::GetFileSize(filePath.c_str()))
         {
             Cache::UpdatePreprocessedCache(filePath, cacheDir.c_str());
             return true; // it needs recompiling.
@@ -820,10 +1598,134 @@ bool IsMetadataCacheFound(const string &projectCacheDir)
     return Cache::FileExists(path.c_str());
 }
 
-void BuildProject(Project proj, BuildMode mode, bool cleanBuild)
+// unity build of the project's sources. returns the translation units to compile, and adds the up-to-date
+// objects to compiledFiles.
+// a clean build plans new batches (balanced using the compile history). an incremental build keeps the
+// previous batches, but a file that was edited is taken out of its batch and compiled on its own from then
+// on, so editing it again only recompiles that file. (it rejoins a batch on the next clean build)
+vector<string> PrepareUnityBuild(const Project &proj, const vector<string> &allFiles, bool cleanBuild, usize jobs,
+                                 const std::unordered_map<string, Cache::CompileStats> &history,
+                                 const string &projCacheDir, const CompileTemplates &templates,
+                                 const std::function<bool(const string &)> &isCommandStale, UnityPlan &plan,
+                                 vector<string> &compiledFiles)
+{
+    string unityDir = Cache::ToAbsolutePath(projCacheDir + "/" + YMAKE_UNITY_DIR);
+    if(!Cache::DirExists(unityDir.c_str()))
+        Cache::CreateDir(unityDir.c_str());
+
+    vector<string> excluded = GetUnityExcludedFiles(proj);
+    auto isExcluded         = [&excluded](const string &file) {
+        return std::find(excluded.begin(), excluded.end(), file) != excluded.end();
+    };
+    auto objectOf = [&projCacheDir, &templates](const string &file) {
+        return GetObjectPath(templates, file, projCacheDir + "/" + "src");
+    };
+
+    // which files need recompiling. (also keeps the metadata caches up to date)
+    std::unordered_set<string> changed;
+    std::unordered_set<string> edited;
+    if(!cleanBuild)
+    {
+        for(const auto &file : allFiles)
+        {
+            bool sourceChanged = false;
+            if(NeedsRecompiling(proj, file, &sourceChanged))
+                changed.insert(file);
+            if(sourceChanged)
+                edited.insert(file);
+        }
+    }
+
+    UnityPlan previous;
+    if(!cleanBuild)
+        previous = LoadUnityPlan(unityDir);
+
+    vector<string> units;
+    if(previous.batches.empty() && previous.isolated.empty())
+    {
+        plan  = PlanUnityBatches(allFiles, excluded, history, jobs);
+        units = GetUnityUnits(plan, unityDir);
+        SaveUnityPlan(unityDir, plan);
+
+        LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "unity build: ", allFiles.size(), " files in ", plan.batches.size(),
+             " batch(es), ", plan.isolated.size(), " on their own.\n");
+        return units;
+    }
+
+    // keep the batch indices (and so their object files) stable.
+    std::unordered_set<string> current(allFiles.begin(), allFiles.end());
+    std::unordered_set<string> planned;
+    for(const auto &batch : previous.batches)
+    {
+        plan.batches.emplace_back();
+        for(const auto &file : batch)
+        {
+            if(current.count(file) == 0) // deleted.
+                continue;
+
+            planned.insert(file);
+            if(edited.count(file) > 0 || isExcluded(file))
+            {
+                LTRACE(true, "unity build: compiling ", file, " on its own from now on.\n");
+                plan.isolated.push_back(file);
+                changed.insert(file); // (its own object file is out of date)
+            }
+            else
+            {
+                plan.batches.back().push_back(file);
+            }
+        }
+    }
+
+    for(const auto &file : previous.isolated)
+    {
+        if(current.count(file) > 0 && planned.insert(file).second)
+            plan.isolated.push_back(file);
+    }
+
+    for(const auto &file : allFiles)
+    {
+        if(planned.insert(file).second) // new.
+        {
+            plan.isolated.push_back(file);
+            changed.insert(file);
+        }
+    }
+
+    for(usize i = 0; i < plan.batches.size(); i++)
+    {
+        const auto &batch = plan.batches[i];
+        if(batch.empty())
+            continue;
+
+        string unityFile = GetUnityFilePath(unityDir, i, batch);
+        bool rewritten   = WriteUnityFile(unityFile, batch);
+        bool outdated    = std::any_of(batch.begin(), batch.end(), [&](const string &f) { return changed.count(f); });
+
+        if(rewritten || outdated || !Cache::FileExists(objectOf(unityFile).c_str()) || isCommandStale(unityFile))
+            units.push_back(unityFile);
+        else
+            compiledFiles.push_back(objectOf(unityFile));
+    }
+
+    for(const auto &file : plan.isolated)
+    {
+        if(changed.count(file) > 0 || !Cache::FileExists(objectOf(file).c_str()) || isCommandStale(file))
+            units.push_back(file);
+        else
+            compiledFiles.push_back(objectOf(file));
+    }
+
+    SaveUnityPlan(unityDir, plan);
+    return units;
+}
+
+void BuildProject(Project proj, BuildMode mode, bool cleanBuild, const BuildOptions &options)
 {
     LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "building project: ", CYAN_TEXT(proj.name), "...\n");
 
+    CheckSourceDateEpoch();
+
     if(!Cache::DirExists(proj.buildDir.c_str()))
     {
         LTRACE(true, BLUE_TEXT("[YMAKE BUILD]: "), "creating build directory: ", CYAN_TEXT(proj.buildDir), "\n");
@@ -841,6 +1743,35 @@ void BuildProject(Project proj, BuildMode mode, bool cleanBuild)
     bool CLEAN_BUILD = cleanBuild || !Cache::DirExists(projCacheDir.c_str()) || !IsMetadataCacheFound(projCacheDir) ||
                        mode == BuildMode::RELEASE;
 
+    // the objects of the last (unity) build can't be reused file by file.
+    string unityCacheFile = projCacheDir + "/" + YMAKE_UNITY_DIR + "/" + YMAKE_UNITY_CACHE_FILENAME;
+    if(!proj.unity && Cache::FileExists(unityCacheFile.c_str()))
+    {
+        CLEAN_BUILD = true;
+        fs::remove(unityCacheFile);
+    }
+
+    // the objects of another pgo build (instrumented, or with another profile) can't be reused.
+    Compiler pgoCompiler = WhatCompiler(proj.cppCompiler.empty() ? proj.cCompiler : proj.cppCompiler);
+    string pgoDir        = GetPGODir(proj.name);
+    if(proj.pgo == YMAKE_PGO_USE && !HasProfile(pgoDir, pgoCompiler))
+    {
+        LLOG(RED_TEXT("[YMAKE ERROR]: "), "no profile for project: ", CYAN_TEXT(proj.name), "\n");
+        LLOG("\tbuild with --pgo=generate, run the program, then: ymake pgo merge ", proj.name, "\n");
+        throw Y::Error(YERR_PGO_PROFILE, "no profile to use.");
+    }
+
+    string pgoKey = GetPGOCacheKey(proj.pgo, pgoDir, pgoCompiler);
+    if(pgoKey != LoadPGOCacheKey(projCacheDir))
+    {
+        LTRACE(true, "pgo changed (", LoadPGOCacheKey(projCacheDir), " -> ", pgoKey, "), rebuilding everything.\n");
+        CLEAN_BUILD = true;
+
+        // profiles of an older instrumented build don't match the new objects.
+        if(proj.pgo == YMAKE_PGO_GENERATE)
+            ClearProfiles(pgoDir);
+    }
+
     //_____________________ INITIAL CACHE SETUP ___________________
     if(CLEAN_BUILD)
     {
@@ -853,6 +1784,7 @@ void BuildProject(Project proj, BuildMode mode, bool cleanBuild)
     f32 percentPerPart = 100.0f / (proj.libs.size() + 1);
 
     vector<Library> compiledLibs;
+    vector<string> failedLibs;
     for(auto lib : proj.libs)
     {
         try
@@ -866,7 +1798,8 @@ void BuildProject(Project proj, BuildMode mode, bool cleanBuild)
                 LTRACE(true, "building library: ", lib.name, "...\n");
             }
 
-            Library compiledLib = BuildLibrary(proj, lib, proj.buildDir.c_str(), percentPerPart, percent, CLEAN_BUILD);
+            Library compiledLib =
+                BuildLibrary(proj, lib, proj.buildDir.c_str(), percentPerPart, percent, options, CLEAN_BUILD);
             compiledLibs.push_back(compiledLib);
         }
         catch(Y::Error &err)
@@ -874,8 +1807,11 @@ void BuildProject(Project proj, BuildMode mode, bool cleanBuild)
             LLOG(RED_TEXT("[YMAKE BUILD]: "), "error building library: ", CYAN_TEXT(lib.name), "\n\t", err.what(),
                  "\n");
 
-            LLOG(RED_TEXT("EXITING....\n"));
-            return;
+            // with --keep-going the other libraries and the project files are still built (just not linked).
+            if(options.onFailure != FailurePolicy::KEEP_GOING || AreProcessesCancelled())
+                throw Y::Error(YERR_BUILD_FAILED, "failed to build a library.");
+
+            failedLibs.push_back(lib.name);
         }
     }
 
@@ -894,6 +1830,18 @@ void BuildProject(Project proj, BuildMode mode, bool cleanBuild)
     if(!Cache::DirExists(cacheDir.c_str()))
         Cache::CreateDir(cacheDir.c_str());
 
+    // precompiled header. every file using it must be recompiled when it changes.
+    bool pchRebuilt = false;
+    PCH pch         = PreparePCH(proj, proj.pch, allFiles, "src", mode, proj.buildType, true, pchRebuilt);
+    if(pchRebuilt && !CLEAN_BUILD)
+    {
+        LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "the precompiled header changed, rebuilding all files.\n");
+        CLEAN_BUILD = true;
+    }
+
+    // the compile command of every file starts with this.
+    CompileTemplates templates = MakeCompileTemplates(proj, mode, proj.buildType, true, pch);
+
     if(CLEAN_BUILD)
     {
         try
@@ -916,13 +1864,48 @@ void BuildProject(Project proj, BuildMode mode, bool cleanBuild)
         }
     }
 
+    // c++20 modules. module units can't be #included, so they're never batched.
+    ModuleBuild modules = PrepareModules(proj, allFiles, mode, proj.buildType);
+    if(modules.Enabled() && proj.unity)
+    {
+        for(const auto &[file, unit] : modules.units)
+            proj.unityExclude.push_back(file);
+    }
+
+    // compile history (for memory admission control and unity batches)
+    auto compileHistory = Cache::LoadCompileStatsCache(projCacheDir.c_str());
+    std::unordered_map<string, Cache::CompileStats> compileStats;
+
+    // the objects whose command changed (flags, defines, compiler, ...) are rebuilt.
+    auto commandKeys    = Cache::LoadObjectCommandsCache(cacheDir);
+    auto isCommandStale = [&templates, &cacheDir, &modules, &commandKeys](const string &file) {
+        return IsObjectCommandStale(templates, file, cacheDir, modules, commandKeys);
+    };
+    MigrateLegacyObjects(templates, allFiles, cacheDir, modules, commandKeys);
+
     vector<string> compiledFiles;
     vector<string> files;
-    if(!CLEAN_BUILD)
+    UnityPlan unityPlan;
+    if(proj.unity)
+    {
+        files = PrepareUnityBuild(proj, allFiles, CLEAN_BUILD, GetJobCount(options), compileHistory, projCacheDir,
+                                  templates, isCommandStale, unityPlan, compiledFiles);
+
+        // progress is per translation unit.
+        filePercent_f = 100.0f / (files.size() + compiledFiles.size());
+        filePercent_f *= (percentPerPart / 100.0f);
+        filePercent         = static_cast<i32>(filePercent_f);
+        filePercent_decimal = static_cast<i32>((filePercent_f - filePercent) * 100);
+
+        percent += (filePercent + filePercent_decimal) * compiledFiles.size();
+        if(percent >= 99.0f)
+            percent = 100.0f;
+    }
+    else if(!CLEAN_BUILD)
     {
         for(auto file : allFiles)
         {
-            if(NeedsRecompiling(proj, file))
+            if(NeedsRecompiling(proj, file) || isCommandStale(file))
             {
                 files.push_back(file);
             }
@@ -933,9 +1916,7 @@ void BuildProject(Project proj, BuildMode mode, bool cleanBuild)
                     percent = 100.0f;
 
                 // LTRACE(true, "file doesn't need recompiling: ", file, "\n");
-                string hashedName = GetHashedFileNameFromPath(file);
-                compiledFiles.push_back(projCacheDir + "/" + "src/" + hashedName + ".o");
-                // LTRACE(true, "\tfilepath: ", projCacheDir + "/" + "src/" + hashedName + ".o", "\n");
+                compiledFiles.push_back(GetObjectPath(templates, file, cacheDir));
             }
         }
     }
@@ -947,49 +1928,186 @@ void BuildProject(Project proj, BuildMode mode, bool cleanBuild)
         }
     }
 
+    // the files importing a module that's rebuilt are rebuilt too.
+    if(modules.Enabled())
+    {
+        vector<string> rebuiltHeaderUnits = BuildHeaderUnits(modules, GetJobCount(options));
+        for(const auto &file : GetModuleRebuilds(modules, files, rebuiltHeaderUnits))
+        {
+            LTRACE(true, "modules: recompiling ", file, " (an imported module changed)\n");
+            files.push_back(file);
+
+            string object = GetObjectPath(templates, file, cacheDir);
+            if(std::find(compiledFiles.begin(), compiledFiles.end(), object) != compiledFiles.end())
+            {
+                compiledFiles.erase(std::remove(compiledFiles.begin(), compiledFiles.end(), object),
+                                    compiledFiles.end());
+                percent -= filePercent + filePercent_decimal;
+            }
+        }
+    }
+
     if(files.size() == 0)
     {
         LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "no changes since last build\n");
     }
 
-    ThreadPool threadPool;
-    for(auto file : files)
+    LTRACE(true, "memory budget for compile jobs: ", GetMemoryBudget(proj) / 1024, " MB\n");
+    LTRACE(true, "max compile jobs: ", GetJobCount(options), (options.autoJobs ? " (auto)" : ""), "\n");
+
+    // a file starts once the modules it imports are built. (without modules, everything is ready at once)
+    ModuleScheduler scheduler(modules, files);
+    vector<string> ready = scheduler.Ready();
+
+    vector<string> oomFiles;
+    BuildFailures failures;
+    while(!ready.empty())
     {
-        threadPool.AddTask([&proj, file, cacheDir, mode, &compiledFiles, &percent, &filePercent, filePercent_decimal,
-                            &threadPool] {
-            try
-            {
-                string compiledFile = CompileFile(proj, file.c_str(), cacheDir.c_str(), mode, proj.buildType, true);
-                compiledFiles.push_back(compiledFile);
-            }
-            catch(Y::Error &err)
-            {
-                LLOG(RED_TEXT("[YMAKE BUILD]: "), "error building file: ", CYAN_TEXT(file), "\n\t", err.what(), "\n");
-                LLOG(RED_TEXT("EXITING....\n"));
+        ThreadPool threadPool(GetJobCount(options));
+        threadPool.SetMemoryBudget(GetMemoryBudget(proj));
+        JobTuner jobTuner(threadPool, options.autoJobs);
+
+        std::function<void(const string &)> addTask;
+        addTask = [&](const string &file) {
+            u64 memCost = PredictPeakRSS(compileHistory, file);
+
+            // (checked under the lock OnJobFailed cancels with, a job added after Cancel() would still run)
+            std::lock_guard<std::mutex> lock(failures.mut);
+            if(failures.cancelled)
                 return;
-            }
 
-            threadPool.Lock();
-            percent += filePercent + filePercent_decimal;
-            if(percent >= 99.0f)
-                percent = 100.0f;
+            threadPool.AddTask(
+                [&templates, file, cacheDir, &compiledFiles, &compileStats, &oomFiles, &percent, &filePercent,
+                 filePercent_decimal, &threadPool, &failures, &options, &modules, &scheduler, &addTask] {
+                    ProcessResult procResult;
+                    try
+                    {
+                        string compiledFile = CompileFile(templates, file, cacheDir, procResult, modules);
+
+                        threadPool.Lock();
+                        compiledFiles.push_back(compiledFile);
+                        compileStats[file] = Cache::CompileStats{procResult.peakRSS, procResult.seconds};
+                        threadPool.Unlock();
+                    }
+                    catch(Y::Error &err)
+                    {
+                        if(err.GetErrNum() == YERR_PROCESS_OOM_KILLED)
+                        {
+                            // re-queued after the other jobs are done. (the files importing it wait for it)
+                            threadPool.Lock();
+                            oomFiles.push_back(file);
+                            threadPool.Unlock();
+                            return;
+                        }
+
+                        if(err.GetErrNum() == YERR_BUILD_CANCELLED)
+                            return;
+
+                        LLOG(RED_TEXT("[YMAKE BUILD]: "), "error building file: ", CYAN_TEXT(file), "\n\t", err.what(),
+                             "\n");
+                        OnJobFailed(failures, threadPool, options, file, err.what());
+
+                        for(const auto &skipped : scheduler.OnFailed(file))
+                        {
+                            std::lock_guard<std::mutex> lock(failures.mut);
+                            failures.files.push_back(skipped);
+                            failures.errors.push_back(skipped +
+                                                      ": not built, it imports a module that failed to build.");
+                        }
+                        return;
+                    }
+
+                    if(!failures.cancelled)
+                    {
+                        for(const auto &next : scheduler.OnBuilt(file))
+                            addTask(next);
+                    }
+
+                    threadPool.Lock();
+                    percent += filePercent + filePercent_decimal;
+                    if(percent >= 99.0f)
+                        percent = 100.0f;
+
+                    if(filePercent_decimal > 0)
+                    {
+                        LLOG(GREEN_TEXT("[YMAKE BUILD]: "), BLUE_TEXT("[", percent, ".", filePercent_decimal, "%] "),
+                             "built file: ", CYAN_TEXT(file), "\n");
+                    }
+                    else
+                    {
+                        LLOG(GREEN_TEXT("[YMAKE BUILD]: "), BLUE_TEXT("[", percent, "%] "),
+                             "built file: ", CYAN_TEXT(file), "\n");
+                    }
+
+                    threadPool.Unlock();
+                },
+                memCost);
+        };
+
+        for(const auto &file : ready)
+            addTask(file);
+
+        threadPool.JoinAll();
+        ready.clear();
+
+        if(!oomFiles.empty())
+        {
+            RetryOOMKilledFiles(proj, oomFiles, cacheDir, templates, GetJobCount(options), compiledFiles,
+                                compileStats, compileHistory, failures, options, modules);
 
-            if(filePercent_decimal > 0)
+            // then the files that were waiting for them.
+            for(const auto &file : oomFiles)
             {
-                LLOG(GREEN_TEXT("[YMAKE BUILD]: "), BLUE_TEXT("[", percent, ".", filePercent_decimal, "%] "),
-                     "built file: ", CYAN_TEXT(file), "\n");
+                if(failures.cancelled)
+                    break;
+
+                if(std::find(failures.files.begin(), failures.files.end(), file) != failures.files.end())
+                {
+                    for(const auto &skipped : scheduler.OnFailed(file))
+                    {
+                        failures.files.push_back(skipped);
+                        failures.errors.push_back(skipped + ": not built, it imports a module that failed to build.");
+                    }
+                    continue;
+                }
+
+                for(const auto &next : scheduler.OnBuilt(file))
+                    ready.push_back(next);
             }
-            else
-            {
-                LLOG(GREEN_TEXT("[YMAKE BUILD]: "), BLUE_TEXT("[", percent, "%] "), "built file: ", CYAN_TEXT(file),
-                     "\n");
-            }
-
-            threadPool.Unlock();
-        });
+            oomFiles.clear();
+        }
     }
 
-    threadPool.JoinAll();
+    if(proj.unity)
+        AttributeUnityStats(unityPlan, Cache::ToAbsolutePath(projCacheDir + "/" + YMAKE_UNITY_DIR), compileHistory,
+                            compileStats);
+
+    SaveObjectCommandKeys(templates, files, cacheDir, modules, compiledFiles, commandKeys);
+
+    for(auto &[file, stats] : compileStats)
+        compileHistory[file] = stats;
+    Cache::SaveCompileStatsCache(projCacheDir.c_str(), compileHistory);
+
+    // report every error at the end (with --keep-going this is the whole set), and don't link.
+    if(failures.Count() > 0 || !failedLibs.empty() || AreProcessesCancelled())
+    {
+        LLOG(RED_TEXT("[YMAKE BUILD FAILED]: "), "project: ", CYAN_TEXT(proj.name), "\n");
+        for(const auto &libName : failedLibs)
+            LLOG("\t", RED_TEXT("library: "), libName, "\n");
+        for(const auto &error : failures.errors)
+            LLOG("\t", RED_TEXT("error: "), error, "\n");
+
+        if(proj.unity)
+        {
+            LLOG(PURPLE_TEXT("\tunity build: "), "if a file only fails when batched with others (ex: conflicting static "
+                 "names), add it to build.unity_exclude.\n");
+        }
+
+        // files that failed must be recompiled next time, even though their sources are now in the cache.
+        Cache::RemoveFromMetadataCache(failures.files, projCacheDir.c_str());
+
+        throw Y::Error(YERR_BUILD_FAILED, "the project failed to build.");
+    }
 
     //____________________ LINK ALL ___________________
     // TODO: use docker etc... to link if in release mode.
@@ -1000,7 +2118,7 @@ void BuildProject(Project proj, BuildMode mode, bool cleanBuild)
     try
     {
         LTRACE(true, "linking everything...\n");
-        outfile = LinkEverything(proj, compiledFiles, compiledLibs, mode);
+        outfile = LinkEverything(proj, compiledFiles, compiledLibs, mode, GetJobCount(options));
     }
     catch(Y::Error &err)
     {
@@ -1016,6 +2134,45 @@ void BuildProject(Project proj, BuildMode mode, bool cleanBuild)
         return;
     }
 
+    SavePGOCacheKey(projCacheDir, pgoKey);
+
+    //____________________ POST LINK ___________________
+    if(mode == BuildMode::RELEASE && proj.buildType == BuildType::EXECUTABLE && !proj.postLink.empty())
+    {
+        string linkExecutable = proj.cppCompiler.empty() ? proj.cCompiler : proj.cppCompiler;
+        string linker         = ResolveLinker(proj.linker, WhatCompiler(linkExecutable), linkExecutable);
+        try
+        {
+            RunPostLink(proj.postLink, proj.train, outfile, GetPostLinkDir(proj.name), linker, [&]() {
+                outfile = LinkEverything(proj, compiledFiles, compiledLibs, mode, GetJobCount(options));
+            });
+        }
+        catch(std::exception &err)
+        {
+            LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "post-link failed: ", err.what(), ". keeping the binary as linked.\n");
+        }
+    }
+
+    //____________________ DEBUG INFO ___________________
+    if(mode == BuildMode::DEBUG && proj.splitDwarf && proj.dwp && proj.buildType != BuildType::STATIC_LIB)
+        PackageDwarf(outfile, WhatCompiler(proj.cppCompiler.empty() ? proj.cCompiler : proj.cppCompiler));
+
+    if(mode == BuildMode::RELEASE && proj.strip)
+    {
+        vector<string> artifacts;
+        if(proj.buildType != BuildType::STATIC_LIB)
+            artifacts.push_back(outfile);
+        for(const auto &lib : compiledLibs)
+        {
+            if(lib.type == BuildType::SHARED_LIB)
+                artifacts.push_back(lib.path);
+            else if(lib.dual)
+                artifacts.push_back(fs::path(lib.path).replace_extension(LIB_DYN_EXT).string());
+        }
+
+        StripArtifacts(artifacts, GetJobCount(options));
+    }
+
     // get final build time
     auto end      = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::seconds>(end - start);
@@ -6,10 +6,31 @@
 
 #include "../toml/parser.h"
 #include "../cache/cache.h"
+#include "../cache/toolchain.h"
 
 #include "mt.h"
+#include "process.h"
+#include "tuner.h"
+#include "jobserver.h"
+#include "unity.h"
+#include "pch.h"
+#include "modules.h"
+#include "linker.h"
+#include "lto.h"
+#include "pgo.h"
+#include "postlink.h"
+#include "debuginfo.h"
+#include "rsp.h"
+#include "archive.h"
+#include "prelink.h"
+#include "exports.h"
+#include "toolprobe.h"
+#include "reproducible.h"
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
+#include <unordered_set>
 
 using namespace Y::Cache;
 
@@ -21,8 +42,25 @@ enum class BuildMode
     RELEASE,
 };
 
+// what happens to the rest of the build when a compile job fails.
+enum class FailurePolicy
+{
+    STOP = 0,   // don't start new jobs, let the running ones finish.
+    FAIL_FAST,  // --fail-fast: don't start new jobs, terminate the running ones.
+    KEEP_GOING, // --keep-going: build everything that doesn't depend on a failure, report all errors at the end.
+};
+
+struct BuildOptions
+{
+    usize jobs    = 0;     // max number of concurrent compile jobs. (0 -> hardware concurrency)
+    bool autoJobs = false; // --jobs=auto: tune the number of jobs during the build based on system load.
+
+    FailurePolicy onFailure = FailurePolicy::STOP;
+    usize maxFailures       = 0; // --keep-going=N: stop after N failures. (0 -> no limit)
+};
+
 // returns a compiler enum value from a string
 
-void BuildProject(Project projects, BuildMode mode, bool cleanBuild);
+void BuildProject(Project projects, BuildMode mode, bool cleanBuild, const BuildOptions &options = {});
 
 } // namespace Y::Build
\ No newline at end of file
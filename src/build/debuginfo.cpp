@@ -0,0 +1,123 @@
+#include "debuginfo.h"
+#include "process.h"
+#include "toolprobe.h"
+#include "mt.h"
+
+#include <map>
+#include <mutex>
+
+using std::string;
+using std::vector;
+
+namespace Y::Build {
+
+// the compression the compiler supports: zstd needs a recent toolchain. (probed once per compiler binary)
+string ResolveCompression(const string &compress, const string &executable)
+{
+    if(compress != YMAKE_DEBUG_COMPRESS_ZSTD)
+        return compress;
+
+    static std::mutex mut;
+    static std::map<string, bool> zstdSupport;
+
+    std::lock_guard<std::mutex> lock(mut);
+    auto entry = zstdSupport.find(executable);
+    if(entry == zstdSupport.end())
+    {
+        bool supported = ToolSupportsFlag(executable, COMP_COMPRESS_DEBUG(YMAKE_DEBUG_COMPRESS_ZSTD));
+        if(!supported)
+            LLOG(YELLOW_TEXT("[YMAKE WARN]: "), executable, " can't compress debug info with zstd, using zlib.\n");
+
+        entry = zstdSupport.emplace(executable, supported).first;
+    }
+
+    return entry->second ? YMAKE_DEBUG_COMPRESS_ZSTD : YMAKE_DEBUG_COMPRESS_ZLIB;
+}
+
+string GetDebugInfoCompileFlags(bool splitDwarf, bool dwp, const string &compress, Cache::Compiler compiler,
+                                const string &executable)
+{
+    if(compiler != Cache::Compiler::GCC && compiler != Cache::Compiler::CLANG)
+        return "";
+
+    string flags;
+    if(splitDwarf)
+    {
+        flags += COMP_SPLIT_DWARF;
+        if(dwp && compiler == Cache::Compiler::GCC)
+            flags += COMP_DWARF_4;
+    }
+
+    if(!compress.empty())
+        flags += COMP_COMPRESS_DEBUG(ResolveCompression(compress, executable));
+
+    return flags;
+}
+
+string GetDebugInfoLinkFlags(const string &compress, Cache::Compiler compiler, const string &executable)
+{
+    if(compress.empty() || (compiler != Cache::Compiler::GCC && compiler != Cache::Compiler::CLANG))
+        return "";
+
+    return COMP_COMPRESS_DEBUG(ResolveCompression(compress, executable));
+}
+
+void PackageDwarf(const string &binary, Cache::Compiler compiler)
+{
+    string dwp = (compiler == Cache::Compiler::CLANG) ? "llvm-dwp" : "dwp";
+    if(!IsToolAvailable(dwp))
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), dwp, " not found, the .dwo files of ", binary, " aren't packaged.\n");
+        return;
+    }
+
+    string command = DWP_PACKAGE(dwp, binary, binary + ".dwp");
+    LTRACE(true, "COMMAND TO PACKAGE DWARF: \n\t", command, "\n");
+
+    ProcessResult result = RunProcess(command);
+    if(result.exitCode != 0)
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "couldn't package the .dwo files of ", binary,
+             ", exit code: ", result.exitCode, "\n");
+        return;
+    }
+
+    LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "packaged debug info: ", CYAN_TEXT(binary + ".dwp"), "\n");
+}
+
+void StripArtifacts(const vector<string> &artifacts, usize jobs)
+{
+    if(!IsToolAvailable("objcopy") || !IsToolAvailable("strip"))
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "objcopy or strip not found, the release artifacts aren't stripped.\n");
+        return;
+    }
+
+    std::mutex logMut;
+    ThreadPool threadPool(jobs == 0 ? 1 : jobs);
+    for(const string &artifact : artifacts)
+    {
+        threadPool.AddTask([artifact, &logMut]() {
+            string debugFile = artifact + ".debug";
+            string command   = OBJCOPY_KEEP_DEBUG(artifact, debugFile) + "&& " + STRIP_UNNEEDED(artifact) + "&& " +
+                             OBJCOPY_DEBUGLINK(debugFile, artifact);
+            LTRACE(true, "COMMAND TO STRIP: \n\t", command, "\n");
+
+            ProcessResult result = RunProcess(command);
+
+            std::lock_guard<std::mutex> lock(logMut);
+            if(result.exitCode != 0)
+            {
+                LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "couldn't strip ", artifact, ", exit code: ", result.exitCode,
+                     "\n");
+                return;
+            }
+
+            LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "stripped ", CYAN_TEXT(artifact), " (debug info: ", debugFile, ")\n");
+        });
+    }
+
+    threadPool.JoinAll();
+}
+
+} // namespace Y::Build
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include "../cache/cache.h"
+
+#include <string>
+#include <vector>
+
+namespace Y::Build {
+
+// compile flags for compiler.debug.split_dwarf and compiler.debug.compress. (debug mode)
+//      split_dwarf: -gsplit-dwarf, the .dwo files stay next to the objects (in YMakeCache), the linker doesn't
+//                   copy them. (gcc + dwp: dwarf 4, binutils' dwp can't package dwarf 5 units)
+//      compress:    -gz=zstd, or -gz=zlib if the compiler can't do zstd.
+std::string GetDebugInfoCompileFlags(bool splitDwarf, bool dwp, const std::string &compress, Cache::Compiler compiler,
+                                     const std::string &executable);
+
+// link flags for compiler.debug.compress. (debug mode)
+std::string GetDebugInfoLinkFlags(const std::string &compress, Cache::Compiler compiler,
+                                  const std::string &executable);
+
+// compiler.debug.dwp: packages the .dwo files of a binary in <binary>.dwp (for debugging it elsewhere).
+// with llvm-dwp for clang, binutils' dwp otherwise.
+void PackageDwarf(const std::string &binary, Cache::Compiler compiler);
+
+// compiler.release.strip: moves the debug info of each artifact to <artifact>.debug (found by the debuggers with a
+// gnu debuglink) and strips it. runs on 'jobs' threads.
+void StripArtifacts(const std::vector<std::string> &artifacts, usize jobs);
+
+} // namespace Y::Build
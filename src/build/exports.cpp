@@ -0,0 +1,96 @@
+#include "exports.h"
+
+#include <filesystem>
+
+using std::string;
+using std::vector;
+namespace fs = std::filesystem;
+
+namespace Y::Build {
+
+// mach-o and pe linkers don't take the gnu flags.
+#if defined(IPLATFORM_WINDOWS) || defined(IPLATFORM_MACOS)
+static const bool elfLinker = false;
+#else
+static const bool elfLinker = true;
+#endif
+
+string GetVisibilityFlags(const string &visibility, Cache::Compiler compiler, Cache::FileType fileType)
+{
+    if(visibility != YMAKE_VISIBILITY_HIDDEN)
+        return "";
+
+    if(compiler != Cache::Compiler::GCC && compiler != Cache::Compiler::CLANG)
+        return "";
+
+    // (c++ only, gcc warns about it on c files)
+    if(fileType == Cache::FileType::C)
+        return COMP_VISIBILITY_HIDDEN;
+
+    return string(COMP_VISIBILITY_HIDDEN) + COMP_VISIBILITY_INLINES_HIDDEN;
+}
+
+string GetExportFlags(const vector<string> &exports, const string &versionScript, Cache::Compiler compiler,
+                      const string &mapPath)
+{
+    if(exports.empty() && versionScript.empty())
+        return "";
+
+    if(!elfLinker || (compiler != Cache::Compiler::GCC && compiler != Cache::Compiler::CLANG))
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "exports and version_script need an ELF linker (gcc, clang), ignoring "
+             "them.\n");
+        return "";
+    }
+
+    // a version script given as is wins.
+    if(!versionScript.empty())
+        return COMP_VERSION_SCRIPT(Cache::ToAbsolutePath(versionScript));
+
+    string cNames, cppNames;
+    for(const string &name : exports)
+    {
+        if(name.find("::") != string::npos)
+            cppNames += "        " + name + ";\n";
+        else
+            cNames += "    " + name + ";\n";
+    }
+
+    string script = "{\n  global:\n" + cNames;
+    if(!cppNames.empty())
+        script += "    extern \"C++\" {\n" + cppNames + "    };\n";
+    script += "  local: *;\n};\n";
+
+    std::error_code ec;
+    fs::create_directories(fs::path(mapPath).parent_path(), ec);
+
+    // (rewritten only when the exports change)
+    if(Cache::WriteFileIfChanged(mapPath, script))
+        LTRACE(true, "wrote version script: ", mapPath, " (", exports.size(), " exports)\n");
+
+    return COMP_VERSION_SCRIPT(Cache::ToAbsolutePath(mapPath));
+}
+
+string GetLinkPresetCompileFlags(bool preset, Cache::Compiler compiler)
+{
+    if(!preset || (compiler != Cache::Compiler::GCC && compiler != Cache::Compiler::CLANG))
+        return "";
+
+    return string(COMP_FUNCTION_SECTIONS) + COMP_DATA_SECTIONS;
+}
+
+string GetLinkPresetFlags(bool preset, Cache::Compiler compiler)
+{
+    if(!preset || (compiler != Cache::Compiler::GCC && compiler != Cache::Compiler::CLANG))
+        return "";
+
+    if(!elfLinker)
+    {
+        LTRACE(true, "compiler.release.link_preset only applies to ELF platforms.\n");
+        return "";
+    }
+
+    return string(COMP_RELEASE_LINK_PRESET) + COMP_GNU_HASH_STYLE;
+}
+
+} // namespace Y::Build
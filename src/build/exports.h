@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include "../cache/cache.h"
+
+#include <string>
+#include <vector>
+
+namespace Y::Build {
+
+// compile flags for visibility = "hidden": -fvisibility=hidden, and -fvisibility-inlines-hidden for c++ files.
+// (gcc, clang) empty for "default" and msvc. (a dll only exports what is marked __declspec(dllexport) anyway)
+std::string GetVisibilityFlags(const std::string &visibility, Cache::Compiler compiler, Cache::FileType fileType);
+
+// link flags limiting the dynamic symbols of a shared library to 'exports', or to a version script. the exports
+// are written as a version script at 'mapPath' (names with "::" are matched demangled) and everything else is
+// local. hidden symbols (visibility = "hidden") stay hidden. empty if neither is set. (version scripts are only read
+// by ELF linkers)
+std::string GetExportFlags(const std::vector<std::string> &exports, const std::string &versionScript,
+                           Cache::Compiler compiler, const std::string &mapPath);
+
+// compiler.release.link_preset: compile flags putting every function and variable in its own section, so the
+// link can drop the unused ones.
+std::string GetLinkPresetCompileFlags(bool preset, Cache::Compiler compiler);
+
+// compiler.release.link_preset: -Wl,--gc-sections,--as-needed,-O1,--hash-style=gnu (ELF platforms)
+std::string GetLinkPresetFlags(bool preset, Cache::Compiler compiler);
+
+} // namespace Y::Build
@@ -0,0 +1,252 @@
+#include "jobserver.h"
+#include "process.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+
+#ifndef IPLATFORM_WINDOWS
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Y::Build {
+
+struct JobServerState
+{
+    bool active = false;
+    bool client = false;
+
+    i32 readFd  = -1;
+    i32 writeFd = -1;
+
+    // only set if we created the fifo. (a fixed buffer, the signal handlers remove it too)
+    char fifoPath[64] = {};
+
+    std::mutex implicitMutex;
+    bool implicitFree = true;
+
+    ~JobServerState()
+    {
+        RemoveJobServerFifo();
+    }
+};
+
+static JobServerState jobServer;
+
+void RemoveJobServerFifo()
+{
+#ifndef IPLATFORM_WINDOWS
+    if(jobServer.fifoPath[0] != '\0')
+        unlink(jobServer.fifoPath);
+#endif
+}
+
+#ifndef IPLATFORM_WINDOWS
+
+bool IsFdValid(i32 fd)
+{
+    return fd >= 0 && fcntl(fd, F_GETFD) != -1;
+}
+
+// looks for --jobserver-auth=... (or the old --jobserver-fds=...) in MAKEFLAGS.
+bool ConnectToParentJobServer()
+{
+    const char *makeflags = std::getenv("MAKEFLAGS");
+    if(makeflags == nullptr)
+        return false;
+
+    std::string auth;
+    std::istringstream iss(makeflags);
+    std::string word;
+    while(iss >> word)
+    {
+        // the last one wins (same as make).
+        if(word.rfind("--jobserver-auth=", 0) == 0)
+            auth = word.substr(strlen("--jobserver-auth="));
+        else if(word.rfind("--jobserver-fds=", 0) == 0)
+            auth = word.substr(strlen("--jobserver-fds="));
+    }
+
+    if(auth.empty())
+        return false;
+
+    if(auth.rfind("fifo:", 0) == 0)
+    {
+        std::string path = auth.substr(strlen("fifo:"));
+        i32 fd           = open(path.c_str(), O_RDWR | O_CLOEXEC);
+        if(fd < 0)
+        {
+            LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "couldn't open the jobserver fifo: ", path, "\n");
+            return false;
+        }
+
+        jobServer.readFd  = fd;
+        jobServer.writeFd = fd;
+    }
+    else
+    {
+        i32 readFd = -1, writeFd = -1;
+        if(std::sscanf(auth.c_str(), "%d,%d", &readFd, &writeFd) != 2)
+            return false;
+
+        if(!IsFdValid(readFd) || !IsFdValid(writeFd))
+        {
+            LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "the jobserver from make is unavailable (prefix the recipe with +).\n");
+            return false;
+        }
+
+        jobServer.readFd  = readFd;
+        jobServer.writeFd = writeFd;
+    }
+
+    return true;
+}
+
+bool CreateJobServer(usize jobs, JobServerStyle style)
+{
+    std::string auth;
+
+    if(style == JobServerStyle::FIFO)
+    {
+        std::string path = "/tmp/ymake-jobserver-" + std::to_string(getpid());
+
+        // removed on ctrl+c too. (the static destructors don't run when the signal is re-raised)
+        InstallSignalHandlers();
+
+        if(mkfifo(path.c_str(), 0600) != 0)
+        {
+            LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "couldn't create the jobserver fifo: ", path, "\n");
+            return false;
+        }
+
+        i32 fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+        if(fd < 0)
+        {
+            unlink(path.c_str());
+            return false;
+        }
+
+        std::snprintf(jobServer.fifoPath, sizeof(jobServer.fifoPath), "%s", path.c_str());
+        jobServer.readFd  = fd;
+        jobServer.writeFd = fd;
+        auth              = "fifo:" + path;
+    }
+    else
+    {
+        // NOTE: no O_CLOEXEC, the children inherit the pipe.
+        i32 fds[2];
+        if(pipe(fds) != 0)
+            return false;
+
+        jobServer.readFd  = fds[0];
+        jobServer.writeFd = fds[1];
+        auth              = std::to_string(fds[0]) + "," + std::to_string(fds[1]);
+    }
+
+    // one slot is ymake's implicit token.
+    for(usize i = 1; i < jobs; i++)
+    {
+        char token = '+';
+        if(write(jobServer.writeFd, &token, 1) != 1)
+            return false;
+    }
+
+    std::string makeflags = "-j" + std::to_string(jobs) + " --jobserver-auth=" + auth;
+    setenv("MAKEFLAGS", makeflags.c_str(), 1);
+
+    LTRACE(true, "created jobserver: MAKEFLAGS=", makeflags, "\n");
+    return true;
+}
+
+#endif
+
+void InitJobServer(usize jobs, JobServerStyle style)
+{
+#ifndef IPLATFORM_WINDOWS
+    if(jobServer.active)
+        return;
+
+    if(ConnectToParentJobServer())
+    {
+        jobServer.active = true;
+        jobServer.client = true;
+        LTRACE(true, "using the jobserver from MAKEFLAGS.\n");
+        return;
+    }
+
+    jobServer.active = CreateJobServer((jobs == 0) ? 1 : jobs, style);
+#else
+    (void)jobs;
+    (void)style;
+#endif
+}
+
+bool IsJobServerActive()
+{
+    return jobServer.active;
+}
+
+bool IsJobServerClient()
+{
+    return jobServer.client;
+}
+
+i32 AcquireJobToken()
+{
+    if(!jobServer.active)
+        return YMAKE_JOBSERVER_NO_TOKEN;
+
+    {
+        std::lock_guard<std::mutex> lock(jobServer.implicitMutex);
+        if(jobServer.implicitFree)
+        {
+            jobServer.implicitFree = false;
+            return YMAKE_JOBSERVER_IMPLICIT_TOKEN;
+        }
+    }
+
+#ifndef IPLATFORM_WINDOWS
+    while(true)
+    {
+        char token;
+        ssize_t n = read(jobServer.readFd, &token, 1);
+        if(n == 1)
+            return static_cast<u8>(token);
+
+        if(n < 0 && errno == EINTR)
+            continue;
+
+        // the jobserver went away. run without a token instead of blocking forever.
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "lost the connection to the jobserver.\n");
+        return YMAKE_JOBSERVER_NO_TOKEN;
+    }
+#else
+    return YMAKE_JOBSERVER_NO_TOKEN;
+#endif
+}
+
+void ReleaseJobToken(i32 token)
+{
+    if(token == YMAKE_JOBSERVER_NO_TOKEN)
+        return;
+
+    if(token == YMAKE_JOBSERVER_IMPLICIT_TOKEN)
+    {
+        std::lock_guard<std::mutex> lock(jobServer.implicitMutex);
+        jobServer.implicitFree = true;
+        return;
+    }
+
+#ifndef IPLATFORM_WINDOWS
+    char byte = static_cast<char>(token);
+    while(write(jobServer.writeFd, &byte, 1) < 0 && errno == EINTR)
+    {
+    }
+#endif
+}
+
+} // namespace Y::Build
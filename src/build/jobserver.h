@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include <string>
+
+namespace Y::Build {
+
+// GNU make jobserver protocol:
+//  every process that runs takes a token (one byte) from a shared pipe/fifo and writes it back when done,
+//  except for one process per client that runs on its implicit token.
+//  ymake is a client when started by make (MAKEFLAGS has --jobserver-auth), otherwise it creates a jobserver
+//  itself and exports it in MAKEFLAGS so compilers/linkers (gcc -flto=jobserver, nested make) share the budget.
+
+enum class JobServerStyle
+{
+    PIPE = 0, // --jobserver-auth=R,W   (every make version)
+    FIFO,     // --jobserver-auth=fifo:PATH   (make 4.4+)
+};
+
+#define YMAKE_JOBSERVER_NO_TOKEN       -2
+#define YMAKE_JOBSERVER_IMPLICIT_TOKEN -1
+
+// connects to the jobserver in MAKEFLAGS, or creates one with (jobs) slots.
+void InitJobServer(usize jobs, JobServerStyle style);
+
+bool IsJobServerActive();
+bool IsJobServerClient();
+
+// blocks until a job slot is available. the token must be given back with ReleaseJobToken.
+i32 AcquireJobToken();
+void ReleaseJobToken(i32 token);
+
+// removes the fifo of a jobserver ymake created. (async-signal-safe, also called from the signal handlers)
+void RemoveJobServerFifo();
+
+} // namespace Y::Build
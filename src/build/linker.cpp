@@ -0,0 +1,174 @@
+#include "linker.h"
+#include "process.h"
+#include "toolprobe.h"
+
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+using std::string;
+
+namespace Y::Build {
+
+// fastest first.
+static const char *fastLinkers[] = {"mold", "lld", "gold"};
+
+// what a probe of a linker was made with: the linker binary the compiler finds. (ld.<linker>, '-' if it isn't
+// installed) the probe is made again when it's installed, removed or upgraded.
+struct LinkerProbe
+{
+    string linkerFingerprint;
+    bool available = false;
+};
+
+// format: one probe per line -> "<compiler fingerprint> <linker> <linker fingerprint> <1 if the compiler can use it>"
+std::map<std::pair<string, string>, LinkerProbe> LoadLinkersCache()
+{
+    std::map<std::pair<string, string>, LinkerProbe> probed;
+
+    std::ifstream cacheFile(string(YMAKE_CACHE_DIR) + "/" + YMAKE_LINKERS_CACHE_FILENAME);
+    string compiler, linker, linkerFingerprint;
+    i32 available = 0;
+    while(cacheFile >> compiler >> linker >> linkerFingerprint >> available)
+        probed[{compiler, linker}] = LinkerProbe{linkerFingerprint, available == 1};
+
+    return probed;
+}
+
+void SaveLinkersCache(const std::map<std::pair<string, string>, LinkerProbe> &probed)
+{
+    if(!Cache::DirExists(YMAKE_CACHE_DIR))
+        Cache::CreateDir(YMAKE_CACHE_DIR);
+
+    std::ofstream cacheFile(string(YMAKE_CACHE_DIR) + "/" + YMAKE_LINKERS_CACHE_FILENAME,
+                            std::ios::out | std::ios::trunc);
+    for(const auto &[key, probe] : probed)
+        cacheFile << key.first << " " << key.second << " " << probe.linkerFingerprint << " "
+                  << (probe.available ? 1 : 0) << "\n";
+}
+
+bool IsLinkerAvailable(const string &executable, const string &linker)
+{
+    static std::mutex mut;
+    static std::map<std::pair<string, string>, LinkerProbe> probed = LoadLinkersCache();
+
+    // (both revalidated by stat once per run)
+    string compilerFingerprint = GetCompilerFingerprint(executable);
+    if(compilerFingerprint.empty())
+        return false;
+
+    string linkerFingerprint = ProbeTool(string(YMAKE_LINKER_BINARY_PREFIX) + linker).fingerprint;
+    if(linkerFingerprint.empty())
+        linkerFingerprint = "-";
+
+    std::lock_guard<std::mutex> lock(mut);
+    auto entry = probed.find({compilerFingerprint, linker});
+    if(entry != probed.end() && entry->second.linkerFingerprint == linkerFingerprint)
+        return entry->second.available;
+
+    // the linker prints its version and exits. (no input needed)
+    string command = executable + " " + COMP_USE_LINKER(linker) + COMP_LINKER_VERSION + COMP_OUTPUT_FILE("/dev/null") +
+                     COMP_SUPPRESS_OUTPUT;
+    LTRACE(true, "COMMAND TO PROBE LINKER: \n\t", command, "\n");
+
+    bool available                        = RunProcess(command).exitCode == 0;
+    probed[{compilerFingerprint, linker}] = LinkerProbe{linkerFingerprint, available};
+    SaveLinkersCache(probed);
+
+    return available;
+}
+
+string ResolveLinker(const string &setting, Cache::Compiler compiler, const string &executable)
+{
+    if(setting.empty())
+        return "";
+
+    if(compiler != Cache::Compiler::GCC && compiler != Cache::Compiler::CLANG)
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "build.linker is only supported with gcc and clang. using the default "
+             "linker.\n");
+        return "";
+    }
+
+    if(setting == YMAKE_LINKER_AUTO)
+    {
+        for(const char *linker : fastLinkers)
+        {
+            if(IsLinkerAvailable(executable, linker))
+                return linker;
+        }
+
+        LTRACE(true, "build.linker = auto: no fast linker available for ", executable, ", using the default.\n");
+        return "";
+    }
+
+    if(!IsLinkerAvailable(executable, setting))
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "linker ", setting, " can't be used with ", executable,
+             ". using the default linker.\n");
+        return "";
+    }
+
+    return setting;
+}
+
+string GetLinkerFlags(const string &linker, usize jobs)
+{
+    if(linker.empty())
+        return "";
+
+    string flags = COMP_USE_LINKER(linker);
+
+    jobs = (jobs == 0) ? 1 : jobs;
+    if(linker == "mold")
+        flags += COMP_MOLD_THREADS(jobs);
+    else if(linker == "lld")
+        flags += COMP_LLD_THREADS(jobs);
+    else if(linker == "gold")
+        flags += COMP_GOLD_THREADS(jobs);
+
+    return flags;
+}
+
+// format: one linker per line -> "<linker> <seconds of the last link>"
+void RecordLinkTime(const string &projCacheDir, const string &linker, f64 seconds)
+{
+    string path = projCacheDir + "/" + YMAKE_LINK_STATS_CACHE_FILENAME;
+    string name = linker.empty() ? "default" : linker;
+
+    std::map<string, f64> linkTimes;
+    {
+        std::ifstream cacheFile(path);
+        string entry;
+        f64 entrySeconds = 0.0;
+        while(cacheFile >> entry >> entrySeconds)
+            linkTimes[entry] = entrySeconds;
+    }
+
+    std::ostringstream message;
+    message << std::fixed << std::setprecision(2) << "linked in " << seconds << "s (" << name << ")";
+
+    string others;
+    for(const auto &[other, otherSeconds] : linkTimes)
+    {
+        if(other == name)
+            continue;
+
+        std::ostringstream entry;
+        entry << std::fixed << std::setprecision(2) << other << ": " << otherSeconds << "s";
+        others += (others.empty() ? "" : ", ") + entry.str();
+    }
+    if(!others.empty())
+        message << ", last link with " << others;
+
+    LLOG(BLUE_TEXT("[YMAKE BUILD]: "), message.str(), "\n");
+
+    linkTimes[name] = seconds;
+    std::ofstream cacheFile(path, std::ios::out | std::ios::trunc);
+    for(const auto &[entry, entrySeconds] : linkTimes)
+        cacheFile << entry << " " << entrySeconds << "\n";
+}
+
+} // namespace Y::Build
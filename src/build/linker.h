@@ -0,0 +1,25 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include "../cache/cache.h"
+
+#include <string>
+
+namespace Y::Build {
+
+// the linker to use for build.linker ("auto", "mold", "lld", "gold" or "bfd"). empty -> the compiler's default.
+// "auto" picks the fastest available one. which linkers a compiler can use is probed (-fuse-ld=x) and cached in
+// YMakeCache/linkers.cache, per compiler binary and linker binary. (probed again when either changes)
+std::string ResolveLinker(const std::string &setting, Cache::Compiler compiler, const std::string &executable);
+
+// -fuse-ld=x and the linker's thread count (the job budget). empty for the compiler's default linker.
+std::string GetLinkerFlags(const std::string &linker, usize jobs);
+
+// saves how long the project took to link with this linker (in YMakeCache/<project>/link_stats.cache) and logs it
+// next to the last link time of the other linkers.
+void RecordLinkTime(const std::string &projCacheDir, const std::string &linker, f64 seconds);
+
+} // namespace Y::Build
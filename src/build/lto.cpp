@@ -0,0 +1,78 @@
+#include "lto.h"
+
+using std::string;
+
+namespace Y::Build {
+
+string GetLTOCompileFlags(const string &lto, Cache::Compiler compiler)
+{
+    if(lto.empty())
+        return "";
+
+    switch(compiler)
+    {
+    case Cache::Compiler::GCC:
+        return COMP_LINK_TIME_OPTIMIZATION;
+    case Cache::Compiler::CLANG:
+        return (lto == YMAKE_LTO_THIN) ? COMP_CLANG_THIN_LTO : COMP_CLANG_FULL_LTO;
+    case Cache::Compiler::MSVC:
+        return COMP_MSVC_LINK_TIME_OPTIMIZATION;
+    default:
+        LTRACE(true, "lto isn't supported with this compiler, ignoring compiler.release.lto.\n");
+        return "";
+    }
+}
+
+string GetLTOLinkFlags(const string &lto, Cache::Compiler compiler, const string &linker, usize jobs,
+                       const string &cacheDir)
+{
+    if(lto.empty())
+        return "";
+
+    jobs = (jobs == 0) ? 1 : jobs;
+
+    // NOTE: msvc's linker restarts with /LTCG by itself when it sees /GL objects.
+    if(compiler == Cache::Compiler::GCC)
+    {
+        string flags = COMP_GCC_LTO_JOBS(jobs);
+        if(lto == YMAKE_LTO_FULL)
+            flags += COMP_GCC_LTO_ONE_PARTITION;
+        return flags;
+    }
+
+    if(compiler != Cache::Compiler::CLANG)
+        return "";
+
+    string flags = GetLTOCompileFlags(lto, compiler);
+    flags += COMP_CLANG_LTO_JOBS(jobs);
+
+    // incremental thin lto: unchanged modules are reused from the cache.
+    if(lto == YMAKE_LTO_THIN && !cacheDir.empty())
+    {
+        if(!Cache::DirExists(cacheDir.c_str()))
+            Cache::CreateDir(cacheDir.c_str());
+
+#if defined(IPLATFORM_MACOS)
+        flags += COMP_LD64_THINLTO_CACHE_DIR(cacheDir);
+#else
+        flags += (linker == "lld") ? COMP_LLD_THINLTO_CACHE_DIR(cacheDir) : COMP_LLVM_PLUGIN_LTO_CACHE_DIR(cacheDir);
+#endif
+    }
+
+    return flags;
+}
+
+string GetLTOArchiver(const string &lto, Cache::Compiler compiler)
+{
+    if(lto.empty())
+        return "";
+
+    if(compiler == Cache::Compiler::GCC)
+        return "gcc-ar";
+    if(compiler == Cache::Compiler::CLANG)
+        return "llvm-ar";
+
+    return "";
+}
+
+} // namespace Y::Build
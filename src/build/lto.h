@@ -0,0 +1,28 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include "../cache/cache.h"
+
+#include <string>
+
+namespace Y::Build {
+
+// compile flags for compiler.release.lto ("thin" or "full"). empty if lto is off.
+//      gcc:   -flto. (gcc has no thin lto, both emit GIMPLE)
+//      clang: -flto=thin / -flto=full
+//      msvc:  /GL
+std::string GetLTOCompileFlags(const std::string &lto, Cache::Compiler compiler);
+
+// link flags matching GetLTOCompileFlags. the lto backends run on 'jobs' threads.
+//      gcc:   -flto=jobs (thin: the program is split in partitions, full: one partition)
+//      clang: -flto-jobs=jobs, thin lto keeps its cache in 'cacheDir' (flag depends on the linker)
+std::string GetLTOLinkFlags(const std::string &lto, Cache::Compiler compiler, const std::string &linker, usize jobs,
+                            const std::string &cacheDir);
+
+// archiver able to index the symbols of lto objects. (gcc-ar, llvm-ar) empty -> any ar.
+std::string GetLTOArchiver(const std::string &lto, Cache::Compiler compiler);
+
+} // namespace Y::Build
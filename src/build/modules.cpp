@@ -0,0 +1,715 @@
+#include "modules.h"
+#include "mt.h"
+#include "pch.h"
+#include "process.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+using std::string;
+using std::vector;
+namespace fs = std::filesystem;
+
+namespace Y::Build {
+
+string Trim(const string &text)
+{
+    usize start = text.find_first_not_of(" \t\r");
+    if(start == string::npos)
+        return "";
+
+    usize end = text.find_last_not_of(" \t\r");
+    return text.substr(start, end - start + 1);
+}
+
+// "m", "m.sub", "m:part"
+bool IsModuleName(const string &name)
+{
+    if(name.empty())
+        return false;
+
+    for(char c : name)
+    {
+        if(!std::isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '.' && c != ':')
+            return false;
+    }
+
+    return true;
+}
+
+string GetUniqueName(const string &name)
+{
+    string stem = fs::path(name).filename().string();
+    stem.erase(std::remove_if(stem.begin(), stem.end(), [](char c) { return c == '<' || c == '>' || c == '"'; }),
+               stem.end());
+
+    return stem + "_" + Cache::HashString(name);
+}
+
+string GetBMIExtension(Cache::Compiler compiler)
+{
+    return (compiler == Cache::Compiler::CLANG) ? ".pcm" : ".gcm";
+}
+
+// module declarations and imports of a file. (lines starting with [export] module/import, outside of comments)
+ModuleUnit ScanModuleDeclarations(const string &file)
+{
+    ModuleUnit unit;
+    unit.file = file;
+
+    std::ifstream source(file);
+    if(!source.is_open())
+        return unit;
+
+    string module; // (without the partition, for "import :part;")
+    bool inComment = false;
+
+    string line;
+    while(std::getline(source, line))
+    {
+        string code;
+        for(usize i = 0; i < line.size(); i++)
+        {
+            if(inComment)
+            {
+                if(line.compare(i, 2, "*/") == 0)
+                {
+                    inComment = false;
+                    i++;
+                }
+                continue;
+            }
+
+            if(line.compare(i, 2, "/*") == 0)
+            {
+                inComment = true;
+                i++;
+                continue;
+            }
+
+            if(line.compare(i, 2, "//") == 0)
+                break;
+
+            code += line[i];
+        }
+
+        code = Trim(code);
+        if(code.empty() || code[0] == '#')
+            continue;
+
+        bool exported = false;
+        if(code.rfind("export ", 0) == 0)
+        {
+            exported = true;
+            code     = Trim(code.substr(7));
+        }
+
+        // (what follows the keyword, so identifiers like "modules" don't match)
+        auto startsWith = [&code](const char *keyword, const string &next) {
+            return code.rfind(keyword, 0) == 0 && code.size() > 6 && next.find(code[6]) != string::npos;
+        };
+
+        bool isModule   = startsWith("module", " ;:");
+        bool isImport   = startsWith("import", " <\":");
+        usize semicolon = code.find(';');
+        if((!isModule && !isImport) || semicolon == string::npos)
+            continue;
+
+        string name = Trim(code.substr(6, semicolon - 6));
+        if(isModule)
+        {
+            // "module;" (global module fragment), "module :private;"
+            if(!IsModuleName(name) || name[0] == ':')
+                continue;
+
+            module = name.substr(0, name.find(':'));
+            if(exported || name.find(':') != string::npos)
+                unit.provides = name;
+            else
+                unit.imports.push_back(name);
+        }
+        else if(!name.empty() && (name[0] == '<' || name[0] == '"'))
+        {
+            if(std::find(unit.headerUnits.begin(), unit.headerUnits.end(), name) == unit.headerUnits.end())
+                unit.headerUnits.push_back(name);
+        }
+        else if(IsModuleName(name))
+        {
+            string imported = (name[0] == ':') ? module + name : name;
+            if(std::find(unit.imports.begin(), unit.imports.end(), imported) == unit.imports.end())
+                unit.imports.push_back(imported);
+        }
+    }
+
+    return unit;
+}
+
+//_______________________________ P1689 ____________________
+
+enum class P1689Scanner
+{
+    NONE = 0,
+    CLANG_SCAN_DEPS,
+    GCC, // gcc >= 14
+};
+
+P1689Scanner FindP1689Scanner(Cache::Compiler compiler, const string &executable, const string &scanDir)
+{
+    if(compiler == Cache::Compiler::CLANG)
+    {
+        string command = string("clang-scan-deps --version") + COMP_SUPPRESS_OUTPUT;
+        return (RunProcess(command).exitCode == 0) ? P1689Scanner::CLANG_SCAN_DEPS : P1689Scanner::NONE;
+    }
+
+    if(compiler == Cache::Compiler::GCC)
+    {
+        string probe   = scanDir + "/probe";
+        string command = executable + " " + COMP_STANDARD_VERSION_CPP(YMAKE_MODULES_MIN_CPP_STD) + COMP_GCC_MODULES +
+                         COMP_PREPROCESS_ONLY + COMP_LANG_CPP + "/dev/null " + COMP_OUTPUT_FILE("/dev/null") +
+                         COMP_GCC_P1689(probe + ".json", probe + ".o") + COMP_SUPPRESS_OUTPUT;
+        return (RunProcess(command).exitCode == 0) ? P1689Scanner::GCC : P1689Scanner::NONE;
+    }
+
+    return P1689Scanner::NONE;
+}
+
+// what's between the brackets of "key": [...] (empty if there's no such array)
+string GetJsonArray(const string &json, const string &key)
+{
+    usize pos = json.find("\"" + key + "\"");
+    if(pos == string::npos)
+        return "";
+
+    usize open = json.find('[', pos);
+    if(open == string::npos)
+        return "";
+
+    i32 depth     = 0;
+    bool inString = false;
+    for(usize i = open; i < json.size(); i++)
+    {
+        char c = json[i];
+        if(inString)
+        {
+            if(c == '\\')
+                i++;
+            else if(c == '"')
+                inString = false;
+            continue;
+        }
+
+        if(c == '"')
+            inString = true;
+        else if(c == '[' || c == '{')
+            depth++;
+        else if((c == ']' || c == '}') && --depth == 0)
+            return json.substr(open + 1, i - open - 1);
+    }
+
+    return "";
+}
+
+// the {...} objects of a json array.
+vector<string> GetJsonObjects(const string &array)
+{
+    vector<string> objects;
+
+    i32 depth     = 0;
+    bool inString = false;
+    usize start   = 0;
+    for(usize i = 0; i < array.size(); i++)
+    {
+        char c = array[i];
+        if(inString)
+        {
+            if(c == '\\')
+                i++;
+            else if(c == '"')
+                inString = false;
+            continue;
+        }
+
+        if(c == '"')
+            inString = true;
+        else if(c == '{' && depth++ == 0)
+            start = i;
+        else if(c == '}' && --depth == 0)
+            objects.push_back(array.substr(start, i - start + 1));
+    }
+
+    return objects;
+}
+
+// value of "key": "value" in a json object. (empty if not found)
+string GetJsonString(const string &object, const string &key)
+{
+    usize pos = object.find("\"" + key + "\"");
+    if(pos == string::npos)
+        return "";
+
+    usize colon = object.find(':', pos + key.size() + 2);
+    usize open  = (colon == string::npos) ? string::npos : object.find('"', colon);
+    if(open == string::npos)
+        return "";
+
+    string value;
+    for(usize i = open + 1; i < object.size() && object[i] != '"'; i++)
+    {
+        if(object[i] == '\\' && i + 1 < object.size())
+            i++;
+        value += object[i];
+    }
+
+    return value;
+}
+
+// provides/imports of a file from its P1689 dependency info. (rescanned when the file is newer than the last scan)
+// returns false if the scanner failed (ex: the file doesn't compile), the caller falls back to the source.
+bool ScanP1689(const string &file, P1689Scanner scanner, const string &compileCommand, const string &scanDir,
+               ModuleUnit &unit)
+{
+    string json   = scanDir + "/" + GetUniqueName(file) + ".json";
+    string object = scanDir + "/" + GetUniqueName(file) + ".o";
+
+    std::error_code err;
+    if(!fs::exists(json) || fs::last_write_time(json, err) < fs::last_write_time(file, err))
+    {
+        string command;
+        if(scanner == P1689Scanner::CLANG_SCAN_DEPS)
+        {
+            command = "clang-scan-deps -format=p1689 -- " + compileCommand + COMP_COMPILE_ONLY + file + " " +
+                      COMP_OUTPUT_FILE(object) + "> " + json;
+        }
+        else
+        {
+            command = compileCommand + COMP_GCC_MODULES + COMP_PREPROCESS_ONLY + COMP_LANG_CPP + file + " " +
+                      COMP_OUTPUT_FILE("/dev/null") + COMP_GCC_P1689(json, object);
+        }
+
+        LTRACE(true, "COMMAND TO SCAN MODULE DEPENDENCIES: \n\t", command, "\n");
+        if(RunProcess(command).exitCode != 0)
+        {
+            fs::remove(json, err);
+            return false;
+        }
+    }
+
+    std::ifstream jsonFile(json);
+    std::ostringstream buff;
+    buff << jsonFile.rdbuf();
+
+    // { "rules": [ { "provides": [ { "logical-name": "m", ... } ], "requires": [ { "logical-name": "n" } ] } ] }
+    string rules = GetJsonArray(buff.str(), "rules");
+    if(rules.empty())
+        return false;
+
+    unit.provides.clear();
+    unit.imports.clear();
+    for(const auto &provided : GetJsonObjects(GetJsonArray(rules, "provides")))
+        unit.provides = GetJsonString(provided, "logical-name");
+
+    for(const auto &required : GetJsonObjects(GetJsonArray(rules, "requires")))
+    {
+        // header units ("include-angle", "include-quote") come from the source. (clang-scan-deps doesn't report them)
+        string lookup = GetJsonString(required, "lookup-method");
+        if(lookup.empty() || lookup == "by-name")
+            unit.imports.push_back(GetJsonString(required, "logical-name"));
+    }
+
+    return true;
+}
+
+//_______________________________ MODULE BUILD ____________________
+
+string GetModuleBMI(const ModuleBuild &build, const string &module)
+{
+    string name = module;
+    std::replace(name.begin(), name.end(), ':', '-'); // (clang's naming for partitions in the prebuilt module path)
+    return build.bmiDir + "/" + name + GetBMIExtension(build.compiler);
+}
+
+// gcc names a header unit after the header it resolves to, find it the way gcc does. (with -H)
+string ResolveHeaderUnit(const ModuleBuild &build, const HeaderUnit &unit)
+{
+    // (gcc prefixes the directory of the importing file, as it's written in the command)
+    string name = unit.name.substr(1, unit.name.size() - 2);
+    if(unit.name.front() == '"' && fs::exists(fs::path(unit.includeDir) / name))
+        return unit.includeDir + "/" + name;
+
+    string probe  = build.bmiDir + "/scan/" + GetUniqueName(unit.name);
+    Cache::WriteFileIfChanged(probe + ".cpp", "#include " + unit.name + "\n");
+
+    string command = build.compileCommand + COMP_QUOTE_INCLUDE_DIR(unit.includeDir) + COMP_PREPROCESS_ONLY +
+                     COMP_SHOW_INCLUDES + probe + ".cpp " + COMP_OUTPUT_FILE("/dev/null") + "2> " + probe + ".txt";
+    if(RunProcess(command).exitCode != 0)
+        return "";
+
+    // ". /usr/include/c++/12/vector" (the first header included)
+    std::ifstream includes(probe + ".txt");
+    string line;
+    while(std::getline(includes, line))
+    {
+        if(line.rfind(". ", 0) == 0)
+            return line.substr(2);
+    }
+
+    return "";
+}
+
+void CheckForImportCycles(const ModuleBuild &build)
+{
+    std::unordered_map<string, i32> state; // 1: visiting, 2: done.
+
+    std::function<void(const string &)> visit = [&](const string &file) {
+        state[file] = 1;
+        for(const auto &module : build.units.at(file).imports)
+        {
+            auto provider = build.providers.find(module);
+            if(provider == build.providers.end() || provider->second == file)
+                continue;
+
+            if(state[provider->second] == 1)
+            {
+                LLOG(RED_TEXT("[YMAKE ERROR]: "), "module import cycle: ", file, " imports ", module,
+                     ", which (indirectly) imports it.\n");
+                throw Y::Error(YERR_MODULE_GRAPH, "module imports form a cycle.");
+            }
+
+            if(state[provider->second] == 0)
+                visit(provider->second);
+        }
+        state[file] = 2;
+    };
+
+    for(const auto &[file, unit] : build.units)
+    {
+        if(state[file] == 0)
+            visit(file);
+    }
+}
+
+ModuleBuild ScanModules(const vector<string> &files, Cache::Compiler compiler, const string &executable,
+                        const string &flags, const string &bmiDir)
+{
+    ModuleBuild build;
+    build.compiler       = compiler;
+    build.compileCommand = executable + " " + flags;
+    build.bmiDir         = Cache::ToAbsolutePath(bmiDir);
+    build.mapper         = build.bmiDir + "/" + YMAKE_MODULE_MAPPER_FILENAME;
+
+    for(const auto &file : files)
+    {
+        if(Cache::GetFileType(file) != Cache::FileType::CPP)
+            continue;
+
+        ModuleUnit unit = ScanModuleDeclarations(file);
+        if(!unit.provides.empty() || !unit.imports.empty() || !unit.headerUnits.empty())
+            build.units[file] = unit;
+    }
+
+    if(!build.Enabled())
+        return ModuleBuild{};
+
+    string scanDir = build.bmiDir + "/scan";
+    if(!Cache::DirExists(scanDir.c_str()))
+        Cache::CreateDir(scanDir.c_str());
+
+    P1689Scanner scanner = FindP1689Scanner(compiler, executable, scanDir);
+    if(scanner == P1689Scanner::NONE)
+        LTRACE(true, "no P1689 scanner for ", executable, ", using the module declarations of the sources.\n");
+
+    for(auto &[file, unit] : build.units)
+    {
+        if(scanner != P1689Scanner::NONE && !ScanP1689(file, scanner, build.compileCommand, scanDir, unit))
+            LTRACE(true, "couldn't scan the module dependencies of ", file, ", using its module declarations.\n");
+
+        if(unit.provides.empty())
+            continue;
+
+        auto [provider, added] = build.providers.emplace(unit.provides, file);
+        if(!added)
+        {
+            LLOG(RED_TEXT("[YMAKE ERROR]: "), "module ", unit.provides, " is declared by both ", provider->second,
+                 " and ", file, "\n");
+            throw Y::Error(YERR_MODULE_GRAPH, "a module is declared by more than one file.");
+        }
+    }
+
+    CheckForImportCycles(build);
+
+    for(const auto &[file, unit] : build.units)
+    {
+        for(const auto &name : unit.headerUnits)
+        {
+            if(build.headerUnits.count(name) > 0)
+                continue;
+
+            HeaderUnit headerUnit;
+            headerUnit.name       = name;
+            headerUnit.bmi        = build.bmiDir + "/hu_" + GetUniqueName(name) + GetBMIExtension(compiler);
+            headerUnit.includeDir = fs::path(file).parent_path().string();
+
+            if(compiler == Cache::Compiler::GCC)
+            {
+                headerUnit.path = ResolveHeaderUnit(build, headerUnit);
+                if(headerUnit.path.empty())
+                {
+                    LLOG(RED_TEXT("[YMAKE ERROR]: "), "couldn't find header unit ", name, " (imported by ", file,
+                         ")\n");
+                    throw Y::Error(YERR_MODULE_GRAPH, "couldn't find a header unit.");
+                }
+            }
+
+            build.headerUnits[name] = headerUnit;
+        }
+    }
+
+    // gcc: "$root dir" then "<module name> <BMI>" lines. (anything else is an unknown module)
+    if(compiler == Cache::Compiler::GCC)
+    {
+        std::ostringstream mapper;
+        mapper << "$root " << build.bmiDir << "\n";
+        for(const auto &[module, file] : build.providers)
+            mapper << module << " " << fs::path(GetModuleBMI(build, module)).filename().string() << "\n";
+        for(const auto &[name, headerUnit] : build.headerUnits)
+            mapper << headerUnit.path << " " << fs::path(headerUnit.bmi).filename().string() << "\n";
+
+        Cache::WriteFileIfChanged(build.mapper, mapper.str());
+    }
+
+    LTRACE(true, "modules: ", build.units.size(), " file(s) use modules, ", build.providers.size(),
+           " module(s) declared, ", build.headerUnits.size(), " header unit(s).\n");
+
+    return build;
+}
+
+string GetHeaderUnitCommand(const ModuleBuild &build, const HeaderUnit &unit)
+{
+    bool system = unit.name.front() == '<';
+    string name = unit.name.substr(1, unit.name.size() - 2);
+
+    string command = build.compileCommand + COMP_QUOTE_INCLUDE_DIR(unit.includeDir);
+    if(build.compiler == Cache::Compiler::CLANG)
+    {
+        command += system ? COMP_CLANG_SYSTEM_HEADER_UNIT : COMP_CLANG_USER_HEADER_UNIT;
+        command += name + " " + COMP_DEPFILE(unit.bmi + ".d") + COMP_OUTPUT_FILE(unit.bmi);
+    }
+    else
+    {
+        // (the mapper tells gcc where the BMI goes) quoted headers are built from the header they resolved to.
+        command += COMP_GCC_MODULES + COMP_GCC_MODULE_MAPPER(build.mapper);
+        command += system ? COMP_GCC_SYSTEM_HEADER_UNIT + name : COMP_LANG_CPP_HEADER + unit.path;
+        command += " " + COMP_DEPFILE(unit.bmi + ".d");
+    }
+
+    return command;
+}
+
+vector<string> BuildHeaderUnits(const ModuleBuild &build, usize jobs)
+{
+    vector<string> rebuilt;
+    vector<string> failed;
+
+    {
+        ThreadPool threadPool(jobs);
+        for(const auto &[name, unit] : build.headerUnits)
+        {
+            string command = GetHeaderUnitCommand(build, unit);
+            string cmdFile = unit.bmi + ".cmd";
+            if(IsOutputUpToDate(unit.bmi, unit.bmi + ".d", cmdFile, command))
+                continue;
+
+            threadPool.AddTask([name = name, command, cmdFile, &rebuilt, &failed, &threadPool] {
+                LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "building header unit: ", CYAN_TEXT(name), "\n");
+                LTRACE(true, "COMMAND TO BUILD HEADER UNIT: \n\t", command, "\n");
+
+                ProcessResult result = RunProcess(command);
+
+                threadPool.Lock();
+                if(result.exitCode == 0)
+                {
+                    Cache::WriteFileIfChanged(cmdFile, command);
+                    rebuilt.push_back(name);
+                }
+                else
+                {
+                    std::error_code err;
+                    fs::remove(cmdFile, err);
+                    failed.push_back(name);
+                }
+                threadPool.Unlock();
+            });
+        }
+
+        threadPool.JoinAll();
+    }
+
+    if(!failed.empty())
+    {
+        for(const auto &name : failed)
+            LLOG(RED_TEXT("[YMAKE COMPILE ERROR]: "), "failed to build header unit: ", name, "\n");
+        throw Y::Error(YERR_BUILD_FAILED, "failed to build a header unit.");
+    }
+
+    return rebuilt;
+}
+
+string GetModuleFlags(const ModuleBuild &build, const string &file)
+{
+    if(!build.Enabled())
+        return "";
+
+    if(build.compiler == Cache::Compiler::GCC)
+        return COMP_GCC_MODULES + COMP_GCC_MODULE_MAPPER(build.mapper);
+
+    string flags = COMP_CLANG_PREBUILT_MODULE_PATH(build.bmiDir);
+
+    auto unit = build.units.find(file);
+    if(unit == build.units.end())
+        return flags;
+
+    if(!unit->second.provides.empty())
+        flags += COMP_CLANG_MODULE_OUTPUT(GetModuleBMI(build, unit->second.provides));
+
+    for(const auto &name : unit->second.headerUnits)
+        flags += COMP_CLANG_MODULE_FILE(build.headerUnits.at(name).bmi);
+
+    return flags;
+}
+
+vector<string> GetModuleRebuilds(const ModuleBuild &build, const vector<string> &files,
+                                 const vector<string> &rebuiltHeaderUnits)
+{
+    std::unordered_set<string> rebuilding(files.begin(), files.end());
+    vector<string> added;
+    auto add = [&](const string &file) {
+        if(rebuilding.insert(file).second)
+            added.push_back(file);
+    };
+
+    for(const auto &[file, unit] : build.units)
+    {
+        if(!unit.provides.empty() && !Cache::FileExists(GetModuleBMI(build, unit.provides).c_str()))
+            add(file);
+
+        for(const auto &name : unit.headerUnits)
+        {
+            if(std::find(rebuiltHeaderUnits.begin(), rebuiltHeaderUnits.end(), name) != rebuiltHeaderUnits.end())
+                add(file);
+        }
+    }
+
+    // the importers of the rebuilt modules. (until nothing is added)
+    bool changed = true;
+    while(changed)
+    {
+        changed = false;
+        for(const auto &[file, unit] : build.units)
+        {
+            if(rebuilding.count(file) > 0)
+                continue;
+
+            for(const auto &module : unit.imports)
+            {
+                auto provider = build.providers.find(module);
+                if(provider != build.providers.end() && rebuilding.count(provider->second) > 0)
+                {
+                    add(file);
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    return added;
+}
+
+//_______________________________ SCHEDULER ____________________
+
+ModuleScheduler::ModuleScheduler(const ModuleBuild &build, const vector<string> &files) : files(files)
+{
+    std::unordered_set<string> building(files.begin(), files.end());
+    for(const auto &file : files)
+    {
+        waiting[file] = 0;
+
+        auto unit = build.units.find(file);
+        if(unit == build.units.end())
+            continue;
+
+        std::unordered_set<string> providers;
+        for(const auto &module : unit->second.imports)
+        {
+            auto provider = build.providers.find(module);
+            if(provider == build.providers.end() || provider->second == file || building.count(provider->second) == 0)
+                continue;
+
+            if(providers.insert(provider->second).second)
+            {
+                importers[provider->second].push_back(file);
+                waiting[file]++;
+            }
+        }
+    }
+}
+
+vector<string> ModuleScheduler::Ready()
+{
+    std::lock_guard<std::mutex> lock(mut);
+
+    vector<string> ready;
+    for(const auto &file : files)
+    {
+        if(waiting[file] == 0 && done.count(file) == 0)
+            ready.push_back(file);
+    }
+
+    return ready;
+}
+
+vector<string> ModuleScheduler::OnBuilt(const string &file)
+{
+    std::lock_guard<std::mutex> lock(mut);
+    done.insert(file);
+
+    vector<string> ready;
+    for(const auto &importer : importers[file])
+    {
+        if(--waiting[importer] == 0 && done.count(importer) == 0)
+            ready.push_back(importer);
+    }
+
+    return ready;
+}
+
+vector<string> ModuleScheduler::OnFailed(const string &file)
+{
+    std::lock_guard<std::mutex> lock(mut);
+    done.insert(file);
+
+    vector<string> skipped;
+    vector<string> stack = {file};
+    while(!stack.empty())
+    {
+        string current = stack.back();
+        stack.pop_back();
+
+        for(const auto &importer : importers[current])
+        {
+            if(done.insert(importer).second)
+            {
+                skipped.push_back(importer);
+                stack.push_back(importer);
+            }
+        }
+    }
+
+    return skipped;
+}
+
+} // namespace Y::Build
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include "../cache/cache.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Y::Build {
+
+// module dependencies of a translation unit.
+struct ModuleUnit
+{
+    std::string file;
+    std::string provides;                 // module (or partition: "m:part") it declares. empty -> none.
+    std::vector<std::string> imports;     // named modules it imports. (an implementation unit imports its module)
+    std::vector<std::string> headerUnits; // header units it imports, as written. ("<vector>", "\"foo.h\"")
+};
+
+struct HeaderUnit
+{
+    std::string name;       // as written in the imports.
+    std::string path;       // gcc: the header it resolves to. (the name gcc gives the header unit)
+    std::string bmi;        // built module interface.
+    std::string includeDir; // directory of the first file importing it. (quoted headers are looked up there first)
+};
+
+// the modules of a project's sources and where their BMIs go.
+struct ModuleBuild
+{
+    Cache::Compiler compiler = Cache::Compiler::NONE;
+    std::string compileCommand; // compiler and flags of the project's c++ files.
+    std::string bmiDir;         // YMakeCache/<project>/modules/<mode>_<compiler>
+    std::string mapper;         // gcc: module mapper file. (module -> BMI)
+
+    std::map<std::string, ModuleUnit> units;                // file -> its modules. (only files using modules)
+    std::unordered_map<std::string, std::string> providers; // module -> file declaring it.
+    std::map<std::string, HeaderUnit> headerUnits;          // name -> header unit.
+
+    bool Enabled() const { return !units.empty(); }
+};
+
+// finds the files declaring or importing modules. files with module declarations are scanned with P1689
+// (clang-scan-deps, or gcc >= 14 with -fdeps-format=p1689r5) when available, the declarations in the source
+// are used otherwise. header units always come from the source.
+// writes the module mapper (gcc). throws YERR_MODULE_GRAPH if a module is declared twice or imports form a cycle.
+// returns a disabled build if no file uses modules.
+ModuleBuild ScanModules(const std::vector<std::string> &files, Cache::Compiler compiler, const std::string &executable,
+                        const std::string &flags, const std::string &bmiDir);
+
+// builds the header units that are missing or out of date (like the precompiled headers), returns the rebuilt ones.
+// throws YERR_BUILD_FAILED if one of them can't be built.
+std::vector<std::string> BuildHeaderUnits(const ModuleBuild &build, usize jobs);
+
+// BMI of a named module.
+std::string GetModuleBMI(const ModuleBuild &build, const std::string &module);
+
+// flags for compiling a file of a module build. (empty if the build doesn't use modules)
+std::string GetModuleFlags(const ModuleBuild &build, const std::string &file);
+
+// files to recompile (besides 'files') because of the modules they import: the files importing (transitively) a
+// module declared in 'files' or a rebuilt header unit, and the files whose BMI is missing.
+std::vector<std::string> GetModuleRebuilds(const ModuleBuild &build, const std::vector<std::string> &files,
+                                           const std::vector<std::string> &rebuiltHeaderUnits);
+
+// starts each file after the files declaring the modules it imports. (thread safe)
+class ModuleScheduler
+{
+    private:
+    std::mutex mut;
+    std::vector<std::string> files;
+    std::unordered_map<std::string, usize> waiting; // file -> number of imported modules that aren't built yet.
+    std::unordered_map<std::string, std::vector<std::string>> importers;
+    std::unordered_set<std::string> done; // built or failed.
+
+    public:
+    ModuleScheduler(const ModuleBuild &build, const std::vector<std::string> &files);
+
+    // files that don't wait for anything. (in order)
+    std::vector<std::string> Ready();
+
+    // returns the files that can start now.
+    std::vector<std::string> OnBuilt(const std::string &file);
+
+    // returns the files that can't be built anymore. (the files importing it, transitively)
+    std::vector<std::string> OnFailed(const std::string &file);
+};
+
+} // namespace Y::Build
@@ -7,13 +7,13 @@
 #include <thread>
 #include <mutex>
 #include <functional>
-#include <queue>
+#include <deque>
 #include <condition_variable>
 
 using std::condition_variable;
+using std::deque;
 using std::function;
 using std::mutex;
-using std::queue;
 using std::thread;
 using std::unique_lock;
 using std::vector;
@@ -34,54 +34,161 @@ namespace Y {
 class ThreadPool
 {
     private:
+    struct Task
+    {
+        function<void()> func;
+        u64 memCost; // predicted peak memory of the task (in KB)
+    };
+
     // vector of worker threads
     vector<thread> workers;
 
     // task queue (handles lambdas with arguments).
-    queue<function<void()>> tasks;
+    deque<Task> tasks;
 
     // synchronization
     mutex qMutex;
     condition_variable cv;
     bool stop;
 
+    // memory admission control (in KB). a budget of 0 means no limit.
+    u64 memBudget = 0;
+    u64 memInUse  = 0;
+    usize running = 0;
+
+    // max number of tasks running at once. (<= number of workers, changed at runtime by --jobs=auto)
+    usize maxActive = 0;
+    usize completed = 0;
+
+    // returns the index of the first task that fits in the memory budget. (must hold qMutex)
+    // if nothing is running, the first task is always admitted (so heavy tasks still run, alone).
+    usize NextTask()
+    {
+        if(running >= maxActive)
+            return tasks.size();
+
+        for(usize i = 0; i < tasks.size(); i++)
+        {
+            if(memBudget == 0 || running == 0 || memInUse + tasks[i].memCost <= memBudget)
+                return i;
+        }
+
+        return tasks.size();
+    }
+
     public:
-    ThreadPool() : stop(false)
+    ThreadPool() : ThreadPool(GetMaxThreads()) {}
+
+    explicit ThreadPool(usize maxThreads) : stop(false)
     {
-        const usize MAX_THREADS = GetMaxThreads();
+        const usize MAX_THREADS = (maxThreads == 0) ? 1 : maxThreads;
+        maxActive               = MAX_THREADS;
         for(size_t i = 0; i < MAX_THREADS; ++i)
         {
             workers.emplace_back([this] {
                 while(true)
                 {
-                    function<void()> task;
+                    Task task;
 
                     {
                         unique_lock<mutex> lock(this->qMutex);
-                        this->cv.wait(lock, [this] { return this->stop || !this->tasks.empty(); });
+                        // (a running task may still add tasks, so workers only leave once nothing is running)
+                        this->cv.wait(lock, [this] {
+                            return (this->stop && this->tasks.empty() && this->running == 0) ||
+                                   this->NextTask() < this->tasks.size();
+                        });
 
-                        if(this->stop && this->tasks.empty())
+                        if(this->stop && this->tasks.empty() && this->running == 0)
                             return;
 
-                        task = std::move(this->tasks.front());
-                        this->tasks.pop();
+                        usize next = this->NextTask();
+                        task       = std::move(this->tasks[next]);
+                        this->tasks.erase(this->tasks.begin() + next);
+
+                        this->memInUse += task.memCost;
+                        this->running++;
+                    }
+
+                    task.func();
+
+                    {
+                        unique_lock<mutex> lock(this->qMutex);
+                        this->memInUse -= task.memCost;
+                        this->running--;
+                        this->completed++;
                     }
 
-                    task();
+                    // a finished task may free enough memory for more than one waiting task.
+                    this->cv.notify_all();
                 }
             });
         }
     }
 
-    void AddTask(function<void()> task)
+    // budget in KB. (0 -> unlimited)
+    void SetMemoryBudget(u64 budget)
+    {
+        {
+            unique_lock<mutex> lock(qMutex);
+            memBudget = budget;
+        }
+        cv.notify_all();
+    }
+
+    // limits how many tasks run at once. (clamped to [1, number of workers])
+    void SetMaxActive(usize count)
+    {
+        {
+            unique_lock<mutex> lock(qMutex);
+            maxActive = (count == 0) ? 1 : (count > workers.size() ? workers.size() : count);
+        }
+        cv.notify_all();
+    }
+
+    usize GetMaxActive()
+    {
+        unique_lock<mutex> lock(qMutex);
+        return maxActive;
+    }
+
+    usize GetRunning()
+    {
+        unique_lock<mutex> lock(qMutex);
+        return running;
+    }
+
+    usize GetQueued()
+    {
+        unique_lock<mutex> lock(qMutex);
+        return tasks.size();
+    }
+
+    usize GetCompleted()
+    {
+        unique_lock<mutex> lock(qMutex);
+        return completed;
+    }
+
+    usize GetWorkerCount() const { return workers.size(); }
+
+    void AddTask(function<void()> task, u64 memCost = 0)
     {
         {
             unique_lock<mutex> lock(qMutex);
-            tasks.push(std::move(task));
+            tasks.push_back(Task{std::move(task), memCost});
         }
         cv.notify_one();
     }
 
+    // drops all queued tasks. (running tasks aren't affected)
+    usize Cancel()
+    {
+        unique_lock<mutex> lock(qMutex);
+        usize dropped = tasks.size();
+        tasks.clear();
+        return dropped;
+    }
+
     void JoinAll()
     {
         { // scope for mutex.
@@ -0,0 +1,283 @@
+#include "pch.h"
+#include "process.h"
+#include "reproducible.h"
+#include "toolprobe.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+
+using std::string;
+using std::vector;
+namespace fs = std::filesystem;
+
+namespace Y::Build {
+
+string GetPCHFlags(const PCH &pch)
+{
+    if(pch.output.empty())
+        return "";
+
+    if(pch.compiler == Cache::Compiler::CLANG)
+        return string(COMP_CLANG_INCLUDE_PCH(pch.output));
+
+    return string(COMP_INCLUDE_FILE(pch.header));
+}
+
+// "#include <x>" -> "<x>", "#include "x"" -> the path it resolves to. (empty if it's not an include)
+string ParseInclude(const string &line, const string &fileDir, const vector<string> &includeDirs)
+{
+    usize open = line.find_first_of("<\"");
+    if(open == string::npos)
+        return "";
+
+    char closing = (line[open] == '<') ? '>' : '"';
+    usize close  = line.find(closing, open + 1);
+    if(close == string::npos)
+        return "";
+
+    string name = line.substr(open + 1, close - open - 1);
+    if(closing == '>')
+        return "<" + name + ">";
+
+    // quoted includes are looked up next to the file first.
+    if(fs::exists(fs::path(fileDir) / name))
+        return Cache::ToAbsolutePath((fs::path(fileDir) / name).string());
+
+    for(const auto &dir : includeDirs)
+    {
+        if(fs::exists(fs::path(dir) / name))
+            return Cache::ToAbsolutePath((fs::path(dir) / name).string());
+    }
+
+    return "";
+}
+
+bool IsHeaderStable(const string &header, const vector<string> &includeDirs)
+{
+    string path = header;
+
+    // <x>: a system header, unless it's in one of the project's include directories.
+    if(header.front() == '<')
+    {
+        path.clear();
+        string name = header.substr(1, header.size() - 2);
+        for(const auto &dir : includeDirs)
+        {
+            if(fs::exists(fs::path(dir) / name))
+            {
+                path = (fs::path(dir) / name).string();
+                break;
+            }
+        }
+
+        if(path.empty())
+            return true;
+    }
+
+    auto lastWrite = std::chrono::system_clock::from_time_t(Cache::GetTimeSinceLastWrite(path.c_str()));
+    return std::chrono::system_clock::now() - lastWrite > std::chrono::hours(YMAKE_PCH_AUTO_STABLE_HOURS);
+}
+
+// format: first line -> hash of the candidates (the headers included by enough files, in order), then one picked
+// header per line. (<header> or a workspace path)
+bool LoadAutoPCHSelection(const string &cachePath, const string &candidatesKey, vector<string> &headers)
+{
+    std::ifstream cacheFile(cachePath);
+    string line;
+    if(!std::getline(cacheFile, line) || line != candidatesKey)
+        return false;
+
+    while(std::getline(cacheFile, line))
+    {
+        if(!line.empty())
+            headers.push_back(line.front() == '<' ? line : Cache::ToAbsolutePath(line));
+    }
+
+    return true;
+}
+
+void SaveAutoPCHSelection(const string &cachePath, const string &candidatesKey, const vector<string> &headers)
+{
+    Cache::CreateDir(fs::path(cachePath).parent_path().string().c_str());
+
+    std::ofstream cacheFile(cachePath, std::ios::out | std::ios::trunc);
+    cacheFile << candidatesKey << "\n";
+    for(const auto &header : headers)
+        cacheFile << (header.front() == '<' ? header : Cache::ToWorkspacePath(header)) << "\n";
+}
+
+vector<string> FindAutoPCHHeaders(const vector<string> &files, const vector<string> &includeDirs,
+                                  const string &cachePath)
+{
+    std::map<string, usize> usage;
+    vector<string> order; // (order of first appearance)
+
+    for(const auto &file : files)
+    {
+        std::ifstream source(file);
+        if(!source.is_open())
+            continue;
+
+        string fileDir = fs::path(file).parent_path().string();
+        std::set<string> included;
+        i32 depth = 0;
+
+        string line;
+        while(std::getline(source, line))
+        {
+            usize hash = line.find_first_not_of(" \t");
+            if(hash == string::npos || line[hash] != '#')
+                continue;
+
+            usize start      = line.find_first_not_of(" \t", hash + 1);
+            string directive = (start == string::npos) ? "" : line.substr(start);
+
+            // includes inside #if blocks depend on the configuration.
+            if(directive.rfind("if", 0) == 0)
+                depth++;
+            else if(directive.rfind("endif", 0) == 0)
+                depth--;
+            else if(depth == 0 && directive.rfind("include", 0) == 0)
+            {
+                string header = ParseInclude(directive, fileDir, includeDirs);
+                if(!header.empty() && included.insert(header).second)
+                {
+                    if(usage[header]++ == 0)
+                        order.push_back(header);
+                }
+            }
+        }
+    }
+
+    usize minUsage = (files.size() * YMAKE_PCH_AUTO_MIN_USAGE_PERCENT + 99) / 100;
+    minUsage       = std::max<usize>(minUsage, 2);
+
+    vector<string> candidates;
+    string candidatesList;
+    for(const auto &header : order)
+    {
+        if(usage[header] < minUsage)
+            continue;
+
+        candidates.push_back(header);
+        candidatesList += (header.front() == '<' ? header : Cache::ToWorkspacePath(header)) + "\n";
+    }
+
+    // the pick is kept until the candidates change, a header turning stable with time doesn't change the pch (and
+    // recompile every file using it) by itself.
+    string candidatesKey = Cache::HashString(candidatesList);
+
+    vector<string> headers;
+    if(LoadAutoPCHSelection(cachePath, candidatesKey, headers))
+        return headers;
+
+    for(const auto &header : candidates)
+    {
+        if(headers.size() >= YMAKE_PCH_AUTO_MAX_HEADERS)
+            break;
+
+        if(IsHeaderStable(header, includeDirs))
+            headers.push_back(header);
+    }
+
+    SaveAutoPCHSelection(cachePath, candidatesKey, headers);
+    return headers;
+}
+
+bool IsOutputUpToDate(const string &output, const string &depFile, const string &cmdFile, const string &command)
+{
+    if(!fs::exists(output) || !fs::exists(depFile))
+        return false;
+
+    std::ifstream lastCommand(cmdFile);
+    std::ostringstream buff;
+    buff << lastCommand.rdbuf();
+    if(buff.str() != command)
+        return false;
+
+    auto builtAt = fs::last_write_time(output);
+    for(const auto &dep : Cache::ParseDepFile(depFile))
+    {
+        std::error_code err;
+        auto depTime = fs::last_write_time(dep, err);
+        if(err || depTime > builtAt)
+        {
+            LTRACE(true, "precompiled header dependency changed: ", dep, "\n");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+PCH BuildPCH(const vector<string> &headers, const string &pchDir, Cache::Compiler compiler, Cache::FileType lang,
+             const string &compileCommand, bool &rebuilt)
+{
+    rebuilt = false;
+
+    if(!Cache::DirExists(pchDir.c_str()))
+        Cache::CreateDir(pchDir.c_str());
+
+    PCH pch;
+    pch.compiler = compiler;
+    pch.lang     = lang;
+    pch.header   = Cache::ToAbsolutePath(pchDir + "/" + YMAKE_PCH_HEADER_FILENAME);
+    pch.output   = pch.header + ((compiler == Cache::Compiler::CLANG) ? ".pch" : ".gch");
+
+    std::ostringstream content;
+    content << "// generated by ymake (precompiled header). do not edit.\n";
+    for(const auto &header : headers)
+    {
+        if(header.front() == '<')
+            content << "#include " << header << "\n";
+        else
+            content << "#include \"" << Cache::ToAbsolutePath(header) << "\"\n";
+    }
+    Cache::WriteFileIfChanged(pch.header, content.str());
+
+    string depFile = pch.header + ".d";
+    string cmdFile = pch.header + ".cmd";
+
+    string command = compileCommand;
+    command += (lang == Cache::FileType::C) ? COMP_LANG_C_HEADER : COMP_LANG_CPP_HEADER;
+    command += pch.header + " ";
+    command += COMP_DEPFILE(depFile);
+    command += COMP_OUTPUT_FILE(pch.output);
+
+    // (and the compiler it was built with, an upgraded compiler rejects it)
+    string key = command + "\n" + GetCompilerFingerprint(compileCommand.substr(0, compileCommand.find(' ')));
+
+    // (__DATE__ and __TIME__ in the headers come from it)
+    string epoch = GetSourceDateEpoch();
+    if(!epoch.empty())
+        key += "\n" + string(YMAKE_SOURCE_DATE_EPOCH_ENV) + "=" + epoch;
+
+    if(IsOutputUpToDate(pch.output, depFile, cmdFile, key))
+        return pch;
+
+    LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "building precompiled header: ", CYAN_TEXT(pch.header), "\n");
+    LTRACE(true, "COMMAND TO BUILD PCH: \n\t", command, "\n");
+
+    rebuilt = true;
+    ProcessResult result = RunProcess(command);
+    if(result.exitCode != 0)
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "couldn't build the precompiled header (exit code: ", result.exitCode,
+             "). building without it.\n");
+
+        std::error_code err;
+        fs::remove(pch.output, err);
+        fs::remove(cmdFile, err);
+        return PCH{};
+    }
+
+    Cache::WriteFileIfChanged(cmdFile, key);
+    return pch;
+}
+
+} // namespace Y::Build
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include "../cache/cache.h"
+
+#include <string>
+#include <vector>
+
+namespace Y::Build {
+
+struct PCH
+{
+    std::string header; // generated header that includes the precompiled headers. (passed with -include on gcc)
+    std::string output; // the precompiled header (.gch or .pch). empty -> no pch.
+
+    Cache::Compiler compiler = Cache::Compiler::NONE;
+    Cache::FileType lang     = Cache::FileType::NONE; // only files of this language use it.
+};
+
+// flags for using a precompiled header.
+// gcc: -include header (gcc uses header.gch next to it), clang: -include-pch header.pch
+std::string GetPCHFlags(const PCH &pch);
+
+// headers for pch = "auto": the #includes (outside of #if blocks) of at least YMAKE_PCH_AUTO_MIN_USAGE_PERCENT of
+// the source files, that haven't changed for YMAKE_PCH_AUTO_STABLE_HOURS when they're picked. the pick is saved at
+// cachePath and kept until the set of headers included by enough files changes. (<header> or an absolute path)
+std::vector<std::string> FindAutoPCHHeaders(const std::vector<std::string> &files,
+                                            const std::vector<std::string> &includeDirs, const std::string &cachePath);
+
+// true if output exists, was built by the same command (saved in cmdFile) and none of the dependencies listed in
+// depFile changed since. (also used for header units)
+bool IsOutputUpToDate(const std::string &output, const std::string &depFile, const std::string &cmdFile,
+                      const std::string &command);
+
+// builds the precompiled header in pchDir if it's missing, its command changed or one of its dependencies (from the
+// depfile of the last build) changed. 'compileCommand' is the compiler and the flags of the files that use it.
+// rebuilt is set if it was (re)built. returns an empty PCH if it couldn't be built.
+PCH BuildPCH(const std::vector<std::string> &headers, const std::string &pchDir, Cache::Compiler compiler,
+             Cache::FileType lang, const std::string &compileCommand, bool &rebuilt);
+
+} // namespace Y::Build
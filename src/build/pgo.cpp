@@ -0,0 +1,167 @@
+#include "pgo.h"
+#include "process.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using std::string;
+using std::vector;
+namespace fs = std::filesystem;
+
+namespace Y::Build {
+
+// profile files in the profile dir with that extension. (sorted)
+vector<string> GetProfileFiles(const string &profileDir, const string &extension)
+{
+    vector<string> files;
+
+    std::error_code ec;
+    if(!fs::exists(profileDir, ec))
+        return files;
+
+    for(const auto &entry : fs::recursive_directory_iterator(profileDir, ec))
+    {
+        if(entry.is_regular_file() && entry.path().extension() == extension)
+            files.push_back(entry.path().string());
+    }
+
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+string GetPGODir(const string &projName)
+{
+    return Cache::ToAbsolutePath(string(YMAKE_CACHE_DIR) + "/" + projName + "/" + YMAKE_PGO_DIR);
+}
+
+string GetPGOFlags(const string &pgo, Cache::Compiler compiler, const string &profileDir)
+{
+    if(pgo.empty())
+        return "";
+
+    if(compiler == Cache::Compiler::GCC)
+    {
+        if(pgo == YMAKE_PGO_GENERATE)
+            return COMP_GCC_PROFILE_GENERATE(profileDir);
+
+        // files the training run didn't reach have no profile.
+        return COMP_GCC_PROFILE_USE(profileDir) + COMP_GCC_NO_MISSING_PROFILE;
+    }
+
+    if(compiler == Cache::Compiler::CLANG)
+    {
+        // %m: one raw profile per binary, merged by the runtime across runs.
+        if(pgo == YMAKE_PGO_GENERATE)
+            return COMP_CLANG_PROFILE_INSTR_GENERATE(profileDir + "/%m.profraw");
+
+        return COMP_CLANG_PROFILE_INSTR_USE(profileDir + "/" + YMAKE_PGO_PROFDATA_FILENAME);
+    }
+
+    LTRACE(true, "pgo is only supported with gcc and clang, ignoring --pgo.\n");
+    return "";
+}
+
+bool HasProfile(const string &profileDir, Cache::Compiler compiler)
+{
+    if(compiler == Cache::Compiler::CLANG)
+        return Cache::FileExists((profileDir + "/" + YMAKE_PGO_PROFDATA_FILENAME).c_str());
+
+    return !GetProfileFiles(profileDir, ".gcda").empty();
+}
+
+void MergeProfiles(const string &profileDir, Cache::Compiler compiler)
+{
+    if(compiler == Cache::Compiler::GCC)
+    {
+        vector<string> gcdaFiles = GetProfileFiles(profileDir, ".gcda");
+        if(gcdaFiles.empty())
+        {
+            LLOG(RED_TEXT("[YMAKE ERROR]: "), "no profile found in: ", profileDir, "\n");
+            LLOG("\tbuild with --pgo=generate and run the program first.\n");
+            throw Y::Error(YERR_PGO_PROFILE, "no profile to merge.");
+        }
+
+        LLOG(GREEN_TEXT("[YMAKE PGO]: "), gcdaFiles.size(), " .gcda file(s) ready, gcc uses them as they are.\n");
+        return;
+    }
+
+    if(compiler != Cache::Compiler::CLANG)
+    {
+        LLOG(RED_TEXT("[YMAKE ERROR]: "), "pgo is only supported with gcc and clang.\n");
+        throw Y::Error(YERR_PGO_PROFILE, "pgo isn't supported with this compiler.");
+    }
+
+    vector<string> rawProfiles = GetProfileFiles(profileDir, ".profraw");
+    if(rawProfiles.empty())
+    {
+        LLOG(RED_TEXT("[YMAKE ERROR]: "), "no raw profile (.profraw) found in: ", profileDir, "\n");
+        LLOG("\tbuild with --pgo=generate and run the program first.\n");
+        throw Y::Error(YERR_PGO_PROFILE, "no profile to merge.");
+    }
+
+    string command = COMP_LLVM_PROFDATA_MERGE(profileDir + "/" + YMAKE_PGO_PROFDATA_FILENAME);
+    for(const string &rawProfile : rawProfiles)
+        command += rawProfile + " ";
+
+    LTRACE(true, "COMMAND TO MERGE PROFILES: \n\t", command, "\n");
+
+    ProcessResult result = RunProcess(command);
+    if(result.exitCode != 0)
+    {
+        LLOG(RED_TEXT("[YMAKE ERROR]: "), "llvm-profdata failed to merge the profiles in: ", profileDir, "\n\t",
+             "exit code: ", result.exitCode, "\n");
+        throw Y::Error(YERR_PGO_PROFILE, "couldn't merge the profiles.");
+    }
+
+    LLOG(GREEN_TEXT("[YMAKE PGO]: "), "merged ", rawProfiles.size(), " raw profile(s) into: ", YMAKE_PGO_PROFDATA_FILENAME,
+         "\n");
+}
+
+void ClearProfiles(const string &profileDir)
+{
+    std::error_code ec;
+    fs::remove_all(profileDir, ec);
+    fs::create_directories(profileDir, ec);
+}
+
+string GetPGOCacheKey(const string &pgo, const string &profileDir, Cache::Compiler compiler)
+{
+    if(pgo != YMAKE_PGO_USE)
+        return pgo;
+
+    vector<string> profiles = (compiler == Cache::Compiler::CLANG)
+                                  ? vector<string>{profileDir + "/" + YMAKE_PGO_PROFDATA_FILENAME}
+                                  : GetProfileFiles(profileDir, ".gcda");
+
+    // the content of the profiles. (file names included, gcc has one per object)
+    string content;
+    for(const string &profile : profiles)
+    {
+        std::ifstream file(profile, std::ios::binary);
+        std::ostringstream oss;
+        oss << file.rdbuf();
+
+        content += profile + "\n" + oss.str();
+    }
+
+    return pgo + " " + Cache::HashString(content);
+}
+
+string LoadPGOCacheKey(const string &projCacheDir)
+{
+    std::ifstream cacheFile(projCacheDir + "/" + YMAKE_PGO_CACHE_FILENAME);
+    string key;
+    std::getline(cacheFile, key);
+    return key;
+}
+
+void SavePGOCacheKey(const string &projCacheDir, const string &key)
+{
+    std::ofstream cacheFile(projCacheDir + "/" + YMAKE_PGO_CACHE_FILENAME, std::ios::out | std::ios::trunc);
+    cacheFile << key << "\n";
+}
+
+} // namespace Y::Build
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include "../cache/cache.h"
+
+#include <string>
+
+namespace Y::Build {
+
+// where the profiles of a project go: YMakeCache/<project>/pgo (absolute, the instrumented program writes there)
+std::string GetPGODir(const std::string &projName);
+
+// compile and link flags for --pgo ("generate" or "use"). empty if pgo is off.
+//      gcc:   -fprofile-generate=dir / -fprofile-use=dir (the .gcda files)
+//      clang: -fprofile-instr-generate=dir/%m.profraw / -fprofile-instr-use=dir/ymake.profdata
+std::string GetPGOFlags(const std::string &pgo, Cache::Compiler compiler, const std::string &profileDir);
+
+// true if there is a profile to use. (gcc: some .gcda file, clang: the merged profile)
+bool HasProfile(const std::string &profileDir, Cache::Compiler compiler);
+
+// ymake pgo merge: clang -> llvm-profdata merges the raw profiles. gcc's .gcda files are used as they are.
+// throws YERR_PGO_PROFILE if there is nothing to merge or llvm-profdata fails.
+void MergeProfiles(const std::string &profileDir, Cache::Compiler compiler);
+
+// removes the profiles of the last instrumented build.
+void ClearProfiles(const std::string &profileDir);
+
+// identifies the objects of a build: the pgo mode and (for "use") a hash of the profile.
+// objects built with another key can't be reused.
+std::string GetPGOCacheKey(const std::string &pgo, const std::string &profileDir, Cache::Compiler compiler);
+
+// key of the last successful build. (YMakeCache/<project>/pgo.cache)
+std::string LoadPGOCacheKey(const std::string &projCacheDir);
+void SavePGOCacheKey(const std::string &projCacheDir, const std::string &key);
+
+} // namespace Y::Build
@@ -0,0 +1,238 @@
+#include "postlink.h"
+#include "process.h"
+#include "toolprobe.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using std::string;
+using std::vector;
+namespace fs = std::filesystem;
+
+namespace Y::Build {
+
+// the training command, running 'binary'.
+string GetTrainingCommand(const string &train, const string &binary)
+{
+    string command = train;
+    usize pos      = command.find(YMAKE_TRAIN_BINARY);
+    if(pos == string::npos)
+        return binary + " " + train + " ";
+
+    while(pos != string::npos)
+    {
+        command.replace(pos, string(YMAKE_TRAIN_BINARY).size(), binary);
+        pos = command.find(YMAKE_TRAIN_BINARY, pos + binary.size());
+    }
+
+    return command + " ";
+}
+
+bool RunPostLinkCommand(const string &what, const string &command)
+{
+    LTRACE(true, "COMMAND TO ", what, ": \n\t", command, "\n");
+
+    ProcessResult result = RunProcess(command);
+    if(result.exitCode != 0)
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "post-link: couldn't ", what, ", exit code: ", result.exitCode,
+             ". keeping the binary as linked.\n");
+        return false;
+    }
+
+    return true;
+}
+
+// hot functions of a perf profile, hottest first. (perf report sorts them by samples)
+vector<string> GetHotSymbols(const string &perfData)
+{
+    string report = perfData + ".report";
+    if(!RunPostLinkCommand("read the perf profile", PERF_REPORT_SYMBOLS(perfData) + "> " + report))
+        return {};
+
+    vector<string> symbols;
+
+    // ex: "    42.10%  [.] _ZN6Server6HandleEv"
+    std::ifstream reportFile(report);
+    string line;
+    while(std::getline(reportFile, line))
+    {
+        if(line.empty() || line[0] == '#')
+            continue;
+
+        // user space symbols only. ([k] -> kernel)
+        usize pos = line.find("[.] ");
+        if(pos == string::npos)
+            continue;
+
+        string symbol = line.substr(pos + 4);
+        symbol        = symbol.substr(0, symbol.find_last_not_of(" \t") + 1);
+        if(!symbol.empty() && symbol.rfind("0x", 0) != 0)
+            symbols.push_back(symbol);
+    }
+
+    return symbols;
+}
+
+string LoadPostLinkKey(const string &postLinkDir)
+{
+    std::ifstream cacheFile(postLinkDir + "/" + YMAKE_POST_LINK_CACHE_FILENAME);
+    string key;
+    std::getline(cacheFile, key);
+    return key;
+}
+
+void SavePostLinkKey(const string &postLinkDir, const string &key)
+{
+    std::ofstream cacheFile(postLinkDir + "/" + YMAKE_POST_LINK_CACHE_FILENAME, std::ios::out | std::ios::trunc);
+    cacheFile << key << "\n";
+}
+
+string GetPostLinkDir(const string &projName)
+{
+    return Cache::ToAbsolutePath(string(YMAKE_CACHE_DIR) + "/" + projName + "/" + YMAKE_POST_LINK_DIR);
+}
+
+string GetPostLinkCompileFlags(const string &postLink)
+{
+    return (postLink == YMAKE_POST_LINK_ORDER) ? COMP_FUNCTION_SECTIONS : "";
+}
+
+string GetPostLinkFlags(const string &postLink, const string &linker, const string &postLinkDir)
+{
+    if(postLink == YMAKE_POST_LINK_BOLT)
+        return COMP_EMIT_RELOCS;
+
+    if(postLink != YMAKE_POST_LINK_ORDER)
+        return "";
+
+    string symbolOrder = postLinkDir + "/" + YMAKE_SYMBOL_ORDER_FILENAME;
+    if(!Cache::FileExists(symbolOrder.c_str()))
+        return "";
+
+    if(linker == "lld" || linker == "mold")
+        return COMP_SYMBOL_ORDERING_FILE(symbolOrder);
+    if(linker == "gold")
+        return COMP_GOLD_SECTION_ORDERING_FILE(postLinkDir + "/" + YMAKE_SECTION_ORDER_FILENAME);
+
+    return "";
+}
+
+void RunBOLT(const string &train, const string &binary, const string &postLinkDir, const string &key)
+{
+    string optimized = postLinkDir + "/" + fs::path(binary).filename().string() + ".bolt";
+    if(LoadPostLinkKey(postLinkDir) == key && Cache::FileExists(optimized.c_str()))
+    {
+        fs::copy_file(optimized, binary, fs::copy_options::overwrite_existing);
+        LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "post-link (bolt): up to date.\n");
+        return;
+    }
+
+    if(!IsToolAvailable("llvm-bolt"))
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "post-link: llvm-bolt not found. keeping the binary as linked.\n");
+        return;
+    }
+
+    LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "post-link (bolt): training the instrumented binary...\n");
+
+    string instrumented = postLinkDir + "/" + fs::path(binary).filename().string() + ".instrumented";
+    string profile      = postLinkDir + "/bolt.fdata";
+    fs::remove(profile);
+
+    if(!RunPostLinkCommand("instrument the binary", BOLT_INSTRUMENT(binary, profile, instrumented)) ||
+       !RunPostLinkCommand("run the training command", GetTrainingCommand(train, instrumented)) ||
+       !RunPostLinkCommand("optimize the binary", BOLT_OPTIMIZE(binary, profile, optimized)))
+        return;
+
+    fs::copy_file(optimized, binary, fs::copy_options::overwrite_existing);
+    SavePostLinkKey(postLinkDir, key);
+
+    LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "post-link (bolt): optimized ", CYAN_TEXT(binary), "\n");
+}
+
+void RunSymbolOrdering(const string &train, const string &binary, const string &postLinkDir, const string &linker,
+                       const string &key, const std::function<void()> &relink)
+{
+    if(LoadPostLinkKey(postLinkDir) == key)
+    {
+        LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "post-link (order): up to date.\n");
+        return;
+    }
+
+    if(linker != "lld" && linker != "mold" && linker != "gold")
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "post-link: symbol ordering needs lld, mold or gold (build.linker). "
+             "keeping the binary as linked.\n");
+        return;
+    }
+
+    if(!IsToolAvailable("perf"))
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "post-link: perf not found. keeping the binary as linked.\n");
+        return;
+    }
+
+    LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "post-link (order): profiling the training command...\n");
+
+    string perfData = postLinkDir + "/perf.data";
+    if(!RunPostLinkCommand("run the training command", PERF_RECORD(perfData) + GetTrainingCommand(train, binary)))
+        return;
+
+    vector<string> symbols = GetHotSymbols(perfData);
+    if(symbols.empty())
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "post-link: the profile has no samples. keeping the binary as linked.\n");
+        return;
+    }
+
+    string symbolOrder;
+    string sectionOrder;
+    for(const string &symbol : symbols)
+    {
+        symbolOrder += symbol + "\n";
+        sectionOrder += ".text." + symbol + "\n";
+    }
+
+    // the binary was linked with the last ordering, it only needs a relink if the order changed.
+    string symbolOrderFile = postLinkDir + "/" + YMAKE_SYMBOL_ORDER_FILENAME;
+    std::ostringstream lastOrder;
+    lastOrder << std::ifstream(symbolOrderFile).rdbuf();
+
+    if(lastOrder.str() != symbolOrder)
+    {
+        std::ofstream(symbolOrderFile, std::ios::out | std::ios::trunc) << symbolOrder;
+        std::ofstream(postLinkDir + "/" + YMAKE_SECTION_ORDER_FILENAME, std::ios::out | std::ios::trunc) << sectionOrder;
+
+        relink();
+    }
+
+    // the key of the relinked binary: the next build links the same one.
+    SavePostLinkKey(postLinkDir, string(YMAKE_POST_LINK_ORDER) + " " + Cache::HashFile(binary) + " " +
+                                     Cache::HashString(train));
+
+    LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "post-link (order): ", symbols.size(), " hot function(s) ordered in ",
+         CYAN_TEXT(binary), "\n");
+}
+
+void RunPostLink(const string &postLink, const string &train, const string &binary, const string &postLinkDir,
+                 const string &linker, const std::function<void()> &relink)
+{
+    if(postLink.empty())
+        return;
+
+    if(!Cache::DirExists(postLinkDir.c_str()))
+        Cache::CreateDir(postLinkDir.c_str());
+
+    // the binary and the training command. (their profile follows from them)
+    string key = postLink + " " + Cache::HashFile(binary) + " " + Cache::HashString(train);
+
+    if(postLink == YMAKE_POST_LINK_BOLT)
+        RunBOLT(train, binary, postLinkDir, key);
+    else if(postLink == YMAKE_POST_LINK_ORDER)
+        RunSymbolOrdering(train, binary, postLinkDir, linker, key, relink);
+}
+
+} // namespace Y::Build
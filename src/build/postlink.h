@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include "../cache/cache.h"
+
+#include <functional>
+#include <string>
+
+namespace Y::Build {
+
+// where the post-link stage keeps its profiles and outputs: YMakeCache/<project>/postlink
+std::string GetPostLinkDir(const std::string &projName);
+
+// compile flags for compiler.release.post_link. (order: one section per function, so they can be moved)
+std::string GetPostLinkCompileFlags(const std::string &postLink);
+
+// link flags for compiler.release.post_link.
+//      bolt:  --emit-relocs (bolt can move the functions around)
+//      order: the ordering file of the last training run, if there is one. (lld, mold or gold)
+std::string GetPostLinkFlags(const std::string &postLink, const std::string &linker, const std::string &postLinkDir);
+
+// optimizes the linked executable with a profile of the training command. (release only)
+//      bolt:  llvm-bolt instruments the binary, the training command runs it, llvm-bolt reorders it.
+//      order: perf samples the training command, the hot functions are written in an ordering file and 'relink'
+//             is called to link the binary again with it.
+// re-runs only if the binary (or the training command) changed since the last time. (postlink.cache)
+// a missing tool or a failed training run is a warning, the binary is left as linked.
+void RunPostLink(const std::string &postLink, const std::string &train, const std::string &binary,
+                 const std::string &postLinkDir, const std::string &linker, const std::function<void()> &relink);
+
+} // namespace Y::Build
@@ -0,0 +1,74 @@
+#include "prelink.h"
+#include "process.h"
+#include "rsp.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+using std::string;
+using std::vector;
+namespace fs = std::filesystem;
+
+namespace Y::Build {
+
+vector<string> PrelinkObjects(const string &prelink, Cache::Compiler compiler, const string &executable, bool lto,
+                              vector<string> objects, const string &output, const string &rspPath)
+{
+    if(compiler != Cache::Compiler::GCC && compiler != Cache::Compiler::CLANG)
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "prelink is only supported with gcc and clang, ", output,
+             " isn't pre-linked.\n");
+        return objects;
+    }
+
+    // a relocatable link would run the lto backend on a part of the program.
+    if(lto)
+    {
+        LTRACE(true, "lto objects aren't pre-linked: ", output, "\n");
+        return objects;
+    }
+
+    // same objects -> same output.
+    std::sort(objects.begin(), objects.end());
+
+    string command = executable + " " + COMP_RELOCATABLE;
+    if(prelink == YMAKE_PRELINK_GC)
+        command += COMP_PRELINK_GC;
+    command += COMP_OUTPUT_FILE(output);
+    command += GetFileArgs(objects, rspPath);
+
+    // the command and the content of the objects.
+    string key = Cache::HashString(Cache::RelocateCommand(command));
+    for(const string &object : objects)
+        key += " " + Cache::HashFile(object);
+
+    string cachePath = (fs::path(output).parent_path() / YMAKE_PRELINK_CACHE_FILENAME).string();
+    string lastKey;
+    std::getline(std::ifstream(cachePath), lastKey);
+
+    if(lastKey == key && Cache::FileExists(output.c_str()))
+    {
+        LTRACE(true, "pre-linked object is up to date: ", output, "\n");
+        return {output};
+    }
+
+    LTRACE(true, "COMMAND TO PRELINK: \n\t", command, "\n");
+    ProcessResult result = RunProcess(command + COMP_SUPPRESS_OUTPUT);
+    if(result.exitCode != 0)
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "couldn't pre-link ", output, ", exit code: ", result.exitCode,
+             ". using the objects.\n");
+
+        std::error_code ec;
+        fs::remove(cachePath, ec);
+        return objects;
+    }
+
+    std::ofstream(cachePath, std::ios::out | std::ios::trunc) << key << "\n";
+    LLOG(BLUE_TEXT("[YMAKE BUILD]: "), "pre-linked ", objects.size(), " objects in ", CYAN_TEXT(output), "\n");
+
+    return {output};
+}
+
+} // namespace Y::Build
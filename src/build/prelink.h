@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include "../cache/cache.h"
+
+#include <string>
+#include <vector>
+
+namespace Y::Build {
+
+// pre-links the objects of a static library in one relocatable object (-r) at 'output', so the final link opens a
+// single input instead of every object. prelink is "on" or "gc". (also drops the sections no exported symbol refers
+// to, works best with -ffunction-sections -fdata-sections)
+// it only runs again when an object or the command changes. (key in YMakeCache/<project>/<lib>/prelink.cache)
+// returns the objects unchanged if they can't be pre-linked. (msvc, lto objects, or the link failed)
+std::vector<std::string> PrelinkObjects(const std::string &prelink, Cache::Compiler compiler,
+                                        const std::string &executable, bool lto, std::vector<std::string> objects,
+                                        const std::string &output, const std::string &rspPath);
+
+} // namespace Y::Build
@@ -0,0 +1,349 @@
+#include "process.h"
+#include "jobserver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <fstream>
+#include <sstream>
+
+#ifndef IPLATFORM_WINDOWS
+    #include <sys/types.h>
+    #include <sys/resource.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+    #include <cerrno>
+    #include <csignal>
+#endif
+
+namespace Y::Build {
+
+// process groups of the running commands. (0 -> free slot)
+// NOTE: lock-free so the signal handler can use it.
+#define YMAKE_MAX_RUNNING_PROCESSES 1024
+static std::atomic<i32> runningProcesses[YMAKE_MAX_RUNNING_PROCESSES];
+static std::atomic<bool> processesCancelled{false};
+
+#ifndef IPLATFORM_WINDOWS
+
+void RegisterProcess(i32 pid)
+{
+    for(auto &slot : runningProcesses)
+    {
+        i32 expected = 0;
+        if(slot.compare_exchange_strong(expected, pid))
+            return;
+    }
+}
+
+void UnregisterProcess(i32 pid)
+{
+    for(auto &slot : runningProcesses)
+    {
+        i32 expected = pid;
+        if(slot.compare_exchange_strong(expected, 0))
+            return;
+    }
+}
+
+// commands run in their own process groups, so they don't get ctrl+c from the terminal.
+// forward it (and SIGTERM/SIGHUP) to them, then die with the same signal.
+void ForwardSignalAndExit(i32 sig)
+{
+    for(auto &slot : runningProcesses)
+    {
+        i32 pid = slot.load();
+        if(pid > 0)
+            kill(-pid, sig);
+    }
+
+    // (the static destructors won't run)
+    RemoveJobServerFifo();
+
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+// also installed before the jobserver fifo is created, so it's removed on ctrl+c.
+void InstallSignalHandlers()
+{
+    static std::once_flag installed;
+    std::call_once(installed, [] {
+        signal(SIGINT, ForwardSignalAndExit);
+        signal(SIGTERM, ForwardSignalAndExit);
+        signal(SIGHUP, ForwardSignalAndExit);
+    });
+}
+
+#endif
+
+void TerminateRunningProcesses()
+{
+    processesCancelled = true;
+
+#ifndef IPLATFORM_WINDOWS
+    for(auto &slot : runningProcesses)
+    {
+        i32 pid = slot.load();
+        if(pid > 0)
+            kill(-pid, SIGTERM);
+    }
+#endif
+}
+
+bool AreProcessesCancelled()
+{
+    return processesCancelled;
+}
+
+// memory.events (cgroup v2) or memory.oom_control (cgroup v1) of ymake's cgroup. empty if not found.
+std::string FindOOMEventsFile()
+{
+#if defined(IPLATFORM_LINUX)
+    std::ifstream cgroupFile("/proc/self/cgroup");
+    if(!cgroupFile.is_open())
+        return "";
+
+    // hierarchy-ID:controller-list:cgroup-path
+    std::string line;
+    while(std::getline(cgroupFile, line))
+    {
+        usize first  = line.find(':');
+        usize second = line.find(':', first + 1);
+        if(first == std::string::npos || second == std::string::npos)
+            continue;
+
+        std::string controllers = line.substr(first + 1, second - first - 1);
+        std::string cgroupPath  = line.substr(second + 1);
+
+        std::string eventsFile;
+        if(controllers.empty())
+            eventsFile = "/sys/fs/cgroup" + cgroupPath + "/memory.events";
+        else if(("," + controllers + ",").find(",memory,") != std::string::npos)
+            eventsFile = "/sys/fs/cgroup/memory" + cgroupPath + "/memory.oom_control";
+
+        if(!eventsFile.empty() && std::ifstream(eventsFile).good())
+            return eventsFile;
+    }
+#endif
+
+    return "";
+}
+
+const std::string &GetOOMEventsFile()
+{
+    static const std::string eventsFile = FindOOMEventsFile();
+    return eventsFile;
+}
+
+bool HasOOMKillCount()
+{
+    return !GetOOMEventsFile().empty();
+}
+
+u64 GetOOMKillCount()
+{
+    const std::string &eventsFile = GetOOMEventsFile();
+    if(eventsFile.empty())
+        return 0;
+
+    std::ifstream events(eventsFile);
+    std::string line;
+    while(std::getline(events, line))
+    {
+        std::istringstream iss(line);
+        std::string key;
+        u64 value = 0;
+        if(iss >> key >> value && key == "oom_kill")
+            return value;
+    }
+
+    return 0;
+}
+
+bool IsOOMKill(const ProcessResult &result, bool driverReportedKill, bool hasOOMKillCount, bool oomKillCountRose)
+{
+    if(result.exitCode == 0)
+        return false;
+
+#ifndef IPLATFORM_WINDOWS
+    // NOTE: the shell reports a SIGKILLed child as exit code 137 when it doesn't exec the command itself.
+    bool sigkilled = (result.signal == SIGKILL || result.exitCode == 128 + SIGKILL);
+#else
+    bool sigkilled = false;
+#endif
+
+    // the counter says a process was killed, this job is one of the killed ones. (not a job that merely failed
+    // at the same time)
+    if(hasOOMKillCount)
+        return oomKillCountRose && (sigkilled || driverReportedKill);
+
+    return result.signal != 0 ? sigkilled : driverReportedKill;
+}
+
+#ifndef IPLATFORM_WINDOWS
+
+// copies the child's stderr to ours until it's closed, and reports whether the driver said its compiler was killed.
+// (the end of the previous read is kept, the diagnostic can be split between two reads)
+bool ForwardStderr(i32 fd)
+{
+    static const std::string gccKilled   = YMAKE_GCC_KILLED_DIAGNOSTIC;
+    static const std::string clangKilled = YMAKE_CLANG_KILLED_DIAGNOSTIC;
+    const usize keep                     = std::max(gccKilled.size(), clangKilled.size());
+
+    bool reported = false;
+    std::string window;
+    char buffer[4096];
+    while(true)
+    {
+        ssize_t count = read(fd, buffer, sizeof(buffer));
+        if(count < 0 && errno == EINTR)
+            continue;
+        if(count <= 0)
+            break;
+
+        for(ssize_t written = 0; written < count;)
+        {
+            ssize_t result = write(STDERR_FILENO, buffer + written, count - written);
+            if(result < 0 && errno == EINTR)
+                continue;
+            if(result <= 0)
+                break;
+            written += result;
+        }
+
+        if(reported)
+            continue;
+
+        window.append(buffer, count);
+        reported = window.find(gccKilled) != std::string::npos || window.find(clangKilled) != std::string::npos;
+        if(window.size() > keep)
+            window.erase(0, window.size() - keep);
+    }
+
+    return reported;
+}
+
+#endif
+
+ProcessResult RunProcess(const std::string &command)
+{
+    ProcessResult result;
+    auto start = std::chrono::steady_clock::now();
+
+#ifndef IPLATFORM_WINDOWS
+    InstallSignalHandlers();
+
+    // one jobserver token per running process. (shared with make/lto-wrapper when MAKEFLAGS has a jobserver)
+    i32 token = AcquireJobToken();
+
+    u64 oomKillsBefore = GetOOMKillCount();
+
+    i32 errPipe[2];
+    if(pipe(errPipe) != 0)
+    {
+        ReleaseJobToken(token);
+        LLOG(RED_TEXT("[YMAKE ERROR]: "), "couldn't create a pipe to run: ", command, "\n");
+        throw Y::Error("couldn't create a pipe.");
+    }
+
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+        close(errPipe[0]);
+        close(errPipe[1]);
+        ReleaseJobToken(token);
+        LLOG(RED_TEXT("[YMAKE ERROR]: "), "couldn't fork a process to run: ", command, "\n");
+        throw Y::Error("couldn't fork a process.");
+    }
+
+    if(pid == 0)
+    {
+        // child.
+        setpgid(0, 0);
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+        signal(SIGHUP, SIG_DFL);
+
+        dup2(errPipe[1], STDERR_FILENO);
+        close(errPipe[0]);
+        close(errPipe[1]);
+
+        execl("/bin/sh", "sh", "-c", command.c_str(), (char *)nullptr);
+        _exit(127);
+    }
+
+    setpgid(pid, pid); // (also done in the child, whichever runs first)
+    RegisterProcess(pid);
+
+    // cancelled while forking.
+    if(processesCancelled)
+        kill(-pid, SIGTERM);
+
+    close(errPipe[1]);
+    bool driverReportedKill = ForwardStderr(errPipe[0]);
+    close(errPipe[0]);
+
+    i32 status = 0;
+    struct rusage usage = {};
+    while(wait4(pid, &status, 0, &usage) < 0)
+    {
+        if(errno != EINTR)
+        {
+            UnregisterProcess(pid);
+            ReleaseJobToken(token);
+            LLOG(RED_TEXT("[YMAKE ERROR]: "), "couldn't wait for process: ", command, "\n");
+            throw Y::Error("couldn't wait for a child process.");
+        }
+    }
+
+    UnregisterProcess(pid);
+    ReleaseJobToken(token);
+
+    if(WIFEXITED(status))
+        result.exitCode = WEXITSTATUS(status);
+    else if(WIFSIGNALED(status))
+    {
+        result.signal   = WTERMSIG(status);
+        result.exitCode = 128 + result.signal;
+    }
+
+    #if defined(IPLATFORM_MACOS)
+    result.peakRSS = static_cast<u64>(usage.ru_maxrss) / 1024; // bytes on macOS.
+    #else
+    result.peakRSS = static_cast<u64>(usage.ru_maxrss); // KB on linux/bsd.
+    #endif
+
+    if(result.exitCode != 0)
+    {
+        bool hasOOMKillCount = HasOOMKillCount();
+        result.oomKilled     = IsOOMKill(result, driverReportedKill, hasOOMKillCount,
+                                         hasOOMKillCount && GetOOMKillCount() > oomKillsBefore);
+    }
+#else
+    result.exitCode = std::system(command.c_str());
+#endif
+
+    auto end       = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<f64>(end - start).count();
+
+    return result;
+}
+
+u64 GetPhysicalMemoryMB()
+{
+#if defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+    long pages    = sysconf(_SC_PHYS_PAGES);
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if(pages <= 0 || pageSize <= 0)
+        return 0;
+
+    return (static_cast<u64>(pages) * static_cast<u64>(pageSize)) / (1024 * 1024);
+#else
+    return 0;
+#endif
+}
+
+} // namespace Y::Build
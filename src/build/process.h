@@ -0,0 +1,50 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include <string>
+
+namespace Y::Build {
+
+struct ProcessResult
+{
+    i32 exitCode = 0;
+    i32 signal   = 0; // signal that terminated the process. (0 if it exited normally)
+
+    u64 peakRSS = 0; // peak resident set size in KB (0 if not available on the platform)
+    f64 seconds = 0.0;
+
+    // failed while the cgroup's oom_kill counter went up, and this job is the one that was killed: it got SIGKILL
+    // (or exited with 137 from the shell), or the compiler driver survived and reported its compiler killed. (gcc
+    // exits with 1 when the OOM killer picks cc1plus) without cgroups, a SIGKILL or the driver's report is enough.
+    bool oomKilled = false;
+};
+
+// runs a shell command and waits for it.
+// on posix the command is run using fork + wait4 so the peak RSS of the child (and its children) is known.
+// each command runs in its own process group, so it can be terminated along with the compiler's sub-processes.
+// its stderr goes through a pipe (forwarded as it comes) so the driver reporting a killed compiler is seen.
+ProcessResult RunProcess(const std::string &command);
+
+// whether a finished command was OOM-killed. (see ProcessResult::oomKilled) driverReportedKill: its output had
+// the driver's "Killed signal terminated program" (or clang's equivalent).
+bool IsOOMKill(const ProcessResult &result, bool driverReportedKill, bool hasOOMKillCount, bool oomKillCountRose);
+
+// forwards ctrl+c (SIGINT, SIGTERM, SIGHUP) to the running commands, then exits with it. (posix, once)
+void InstallSignalHandlers();
+
+// sends SIGTERM to every process started by RunProcess that is still running (and its children).
+// processes that fail after this are reported as cancelled.
+void TerminateRunningProcesses();
+bool AreProcessesCancelled();
+
+// number of OOM kills in ymake's cgroup so far. (0 if cgroups aren't available)
+u64 GetOOMKillCount();
+bool HasOOMKillCount();
+
+// total physical memory in MB. (0 if unknown)
+u64 GetPhysicalMemoryMB();
+
+} // namespace Y::Build
@@ -0,0 +1,61 @@
+#include "reproducible.h"
+#include "toolprobe.h"
+
+#include <cstdlib>
+
+using std::string;
+
+namespace Y::Build {
+
+string GetPrefixMapFlags(Cache::Compiler compiler, const string &executable)
+{
+    if(compiler != Cache::Compiler::GCC && compiler != Cache::Compiler::CLANG)
+        return "";
+
+    // (probed with a fixed mapping, so the probe is cached once for every checkout)
+    string root = Cache::GetWorkspaceRoot();
+    if(ToolSupportsFlag(executable, COMP_FILE_PREFIX_MAP(".", ".")))
+        return COMP_FILE_PREFIX_MAP(root, ".");
+
+    return COMP_DEBUG_PREFIX_MAP(root, ".");
+}
+
+void CheckSourceDateEpoch()
+{
+    static bool checked = false;
+    if(checked)
+        return;
+    checked = true;
+
+    const char *value = std::getenv(YMAKE_SOURCE_DATE_EPOCH_ENV);
+    if(value == nullptr)
+        return;
+
+    // a non-negative integer, at most the end of year 9999. (what gcc takes)
+    string epoch = value;
+    bool valid   = !epoch.empty() && epoch.size() <= 12 && epoch.find_first_not_of("0123456789") == string::npos &&
+                 std::stoull(epoch) <= YMAKE_SOURCE_DATE_EPOCH_MAX;
+    if(valid)
+    {
+        LTRACE(true, YMAKE_SOURCE_DATE_EPOCH_ENV, "=", epoch, ", used by the compilers for __DATE__ and __TIME__.\n");
+        return;
+    }
+
+    LLOG(YELLOW_TEXT("[YMAKE WARN]: "), YMAKE_SOURCE_DATE_EPOCH_ENV, "=\"", epoch,
+         "\" isn't a timestamp (seconds since the epoch), ignoring it.\n");
+#if defined(IPLATFORM_WINDOWS)
+    _putenv_s(YMAKE_SOURCE_DATE_EPOCH_ENV, "");
+#else
+    unsetenv(YMAKE_SOURCE_DATE_EPOCH_ENV);
+#endif
+}
+
+string GetSourceDateEpoch()
+{
+    CheckSourceDateEpoch();
+
+    const char *value = std::getenv(YMAKE_SOURCE_DATE_EPOCH_ENV);
+    return (value != nullptr) ? value : "";
+}
+
+} // namespace Y::Build
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include "../cache/cache.h"
+
+#include <string>
+
+namespace Y::Build {
+
+// compile flags mapping the workspace root to '.' in what the compiler writes in an object (debug info, __FILE__,
+// ...), so the objects are the same in every checkout: -ffile-prefix-map, or -fdebug-prefix-map if the compiler
+// doesn't have it. (gcc, clang)
+std::string GetPrefixMapFlags(Cache::Compiler compiler, const std::string &executable);
+
+// SOURCE_DATE_EPOCH: gcc and clang use it for __DATE__ and __TIME__, and fail every compile if it isn't a
+// timestamp. an invalid value is reported once and unset, so the build still runs.
+void CheckSourceDateEpoch();
+
+// the SOURCE_DATE_EPOCH the compilers see (after CheckSourceDateEpoch), "" if it isn't set. part of the object and
+// pch keys, the objects change with it.
+std::string GetSourceDateEpoch();
+
+} // namespace Y::Build
@@ -0,0 +1,49 @@
+#include "rsp.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using std::string;
+using std::vector;
+namespace fs = std::filesystem;
+
+namespace Y::Build {
+
+string GetResponseFilePath(const string &projName, const string &target)
+{
+    return Cache::ToAbsolutePath(string(YMAKE_CACHE_DIR) + "/" + projName + "/" + YMAKE_RESPONSE_FILES_DIR + "/" +
+                                 target + ".rsp");
+}
+
+string GetFileArgs(const vector<string> &files, const string &rspPath)
+{
+    string args;
+    for(const string &file : files)
+        args += file + " ";
+
+    if(args.size() <= YMAKE_RESPONSE_FILE_THRESHOLD)
+        return args;
+
+    // paths with spaces are quoted, like on a command line.
+    string content;
+    for(const string &file : files)
+        content += (file.find(' ') != string::npos) ? "\"" + file + "\"\n" : file + "\n";
+
+    std::ostringstream oldContent;
+    oldContent << std::ifstream(rspPath, std::ios::binary).rdbuf();
+
+    if(oldContent.str() != content)
+    {
+        std::error_code ec;
+        fs::create_directories(fs::path(rspPath).parent_path(), ec);
+
+        std::ofstream rspFile(rspPath, std::ios::binary | std::ios::out | std::ios::trunc);
+        rspFile << content;
+        LTRACE(true, "wrote response file: ", rspPath, " (", files.size(), " files)\n");
+    }
+
+    return COMP_RESPONSE_FILE(rspPath);
+}
+
+} // namespace Y::Build
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include "../cache/cache.h"
+
+#include <string>
+#include <vector>
+
+namespace Y::Build {
+
+// response file of a command: YMakeCache/<project>/rsp/<target>.rsp
+std::string GetResponseFilePath(const std::string &projName, const std::string &target);
+
+// the files as command arguments. if they are longer than YMAKE_RESPONSE_FILE_THRESHOLD, they are written in the
+// response file (one per line) and passed as @rspPath. (compilers, linkers, ar, llvm-ar and lib all read them)
+// the response file is only rewritten when the list changes.
+std::string GetFileArgs(const std::vector<std::string> &files, const std::string &rspPath);
+
+} // namespace Y::Build
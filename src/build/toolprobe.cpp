@@ -0,0 +1,298 @@
+#include "toolprobe.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#if defined(IPLATFORM_WINDOWS)
+    #include <process.h>
+#else
+    #include <unistd.h>
+#endif
+
+using std::string;
+using std::vector;
+namespace fs = std::filesystem;
+
+namespace Y::Build {
+
+#if defined(IPLATFORM_WINDOWS)
+static const char pathSeparator  = ';';
+static const char *executableExt = ".exe";
+#else
+static const char pathSeparator  = ':';
+static const char *executableExt = "";
+#endif
+
+// the binary running 'tool' would start. (symlinks resolved, empty if it isn't found)
+string ResolveToolPath(const string &tool)
+{
+    vector<fs::path> candidates;
+    if(tool.find('/') != string::npos || tool.find('\\') != string::npos)
+    {
+        candidates.push_back(tool);
+    }
+    else
+    {
+        const char *pathEnv = std::getenv("PATH");
+        std::istringstream dirs(pathEnv ? pathEnv : "");
+        string dir;
+        while(std::getline(dirs, dir, pathSeparator))
+        {
+            if(!dir.empty())
+                candidates.push_back(fs::path(dir) / (tool + executableExt));
+        }
+    }
+
+    std::error_code ec;
+    for(const fs::path &candidate : candidates)
+    {
+        if(!fs::is_regular_file(candidate, ec))
+            continue;
+
+        fs::path resolved = fs::canonical(candidate, ec);
+        return ec ? candidate.string() : resolved.string();
+    }
+
+    return "";
+}
+
+bool StatTool(const string &path, u64 &size, i64 &mtime)
+{
+    std::error_code ec;
+    size = fs::file_size(path, ec);
+    if(ec)
+        return false;
+
+    auto time = fs::last_write_time(path, ec);
+    if(ec)
+        return false;
+
+    mtime = static_cast<i64>(time.time_since_epoch().count());
+    return true;
+}
+
+// a temp file for the output of one probe. (unique to the process and the probe, two ymake runs sharing a cache or
+// probes from worker threads don't read each other's output)
+string GetProbeOutputPath()
+{
+    static std::atomic<u32> probes{0};
+
+#if defined(IPLATFORM_WINDOWS)
+    i64 pid = _getpid();
+#else
+    i64 pid = getpid();
+#endif
+
+    std::error_code ec;
+    fs::path dir = fs::temp_directory_path(ec);
+    if(ec)
+        dir = YMAKE_CACHE_DIR;
+
+    string name = "ymake_probe_" + std::to_string(pid) + "_" + std::to_string(probes++) + ".out";
+    return (dir / name).string();
+}
+
+// first line the command prints. (stdout and stderr, some tools print their version on stderr)
+string GetFirstOutputLine(const string &command, bool &succeeded)
+{
+    if(!Cache::DirExists(YMAKE_CACHE_DIR))
+        Cache::CreateDir(YMAKE_CACHE_DIR);
+
+    string outFile = GetProbeOutputPath();
+    LTRACE(true, "COMMAND TO PROBE TOOL: \n\t", command, "\n");
+    succeeded = std::system((command + "> \"" + outFile + "\" 2>&1").c_str()) == 0;
+
+    string line;
+    std::getline(std::ifstream(outFile), line);
+
+    std::error_code ec;
+    fs::remove(outFile, ec);
+
+    // (it's stored in a tab separated file)
+    for(char &c : line)
+    {
+        if(c == '\t' || c == '\r')
+            c = ' ';
+    }
+
+    return line;
+}
+
+// format: one tool per line, tab separated ->
+// "<tool> <1 if available> <path> <size> <mtime> <fingerprint> <target> <version> [<1 if supported><flag> ...]"
+std::map<string, ToolInfo> LoadToolchainCache()
+{
+    std::map<string, ToolInfo> tools;
+
+    std::ifstream cacheFile(string(YMAKE_CACHE_DIR) + "/" + YMAKE_TOOLCHAIN_CACHE_FILENAME);
+    string line;
+    while(std::getline(cacheFile, line))
+    {
+        vector<string> fields;
+        std::istringstream iss(line);
+        string field;
+        while(std::getline(iss, field, '\t'))
+            fields.push_back(field);
+
+        if(fields.size() < 8)
+            continue;
+
+        try
+        {
+            ToolInfo info;
+            info.available   = (fields[1] == "1");
+            info.path        = fields[2];
+            info.size        = std::stoull(fields[3]);
+            info.mtime       = std::stoll(fields[4]);
+            info.fingerprint = fields[5];
+            info.target      = fields[6];
+            info.version     = fields[7];
+
+            for(usize i = 8; i < fields.size(); i++)
+            {
+                if(fields[i].size() > 1)
+                    info.flags[fields[i].substr(1)] = (fields[i][0] == '1');
+            }
+
+            tools[fields[0]] = info;
+        }
+        catch(const std::exception &)
+        {
+            // a broken line, the tool is probed again.
+        }
+    }
+
+    return tools;
+}
+
+void SaveToolchainCache(const std::map<string, ToolInfo> &tools)
+{
+    if(!Cache::DirExists(YMAKE_CACHE_DIR))
+        Cache::CreateDir(YMAKE_CACHE_DIR);
+
+    std::ofstream cacheFile(string(YMAKE_CACHE_DIR) + "/" + YMAKE_TOOLCHAIN_CACHE_FILENAME,
+                            std::ios::out | std::ios::trunc);
+    for(const auto &[tool, info] : tools)
+    {
+        cacheFile << tool << "\t" << (info.available ? 1 : 0) << "\t" << info.path << "\t" << info.size << "\t"
+                  << info.mtime << "\t" << info.fingerprint << "\t" << info.target << "\t" << info.version;
+        for(const auto &[flag, supported] : info.flags)
+            cacheFile << "\t" << (supported ? 1 : 0) << flag;
+        cacheFile << "\n";
+    }
+}
+
+static std::mutex probeMut;
+
+// (probeMut must be held)
+std::map<string, ToolInfo> &GetProbedTools()
+{
+    static std::map<string, ToolInfo> tools = LoadToolchainCache();
+    return tools;
+}
+
+// the probe of a tool, revalidated once per run. (probeMut must be held)
+ToolInfo &GetProbedTool(const string &tool)
+{
+    static std::set<string> validated;
+
+    std::map<string, ToolInfo> &tools = GetProbedTools();
+
+    ToolInfo &info = tools[tool];
+    if(!validated.insert(tool).second)
+        return info;
+
+    string path = ResolveToolPath(tool);
+    u64 size    = 0;
+    i64 mtime   = 0;
+    if(!path.empty())
+        StatTool(path, size, mtime);
+
+    // same binary -> same probe. (a tool that isn't found stays unavailable, nothing to run)
+    if(path == info.path && size == info.size && mtime == info.mtime)
+        return info;
+
+    LTRACE(true, "probing tool: ", tool, " (", (path.empty() ? "not found" : path), ")\n");
+
+    info       = ToolInfo{};
+    info.path  = path;
+    info.size  = size;
+    info.mtime = mtime;
+
+    if(!path.empty())
+    {
+        info.version = GetFirstOutputLine(tool + " " + COMP_TOOL_VERSION, info.available);
+
+        Cache::Compiler compiler = Cache::WhatCompiler(tool);
+        if(info.available && (compiler == Cache::Compiler::GCC || compiler == Cache::Compiler::CLANG ||
+                              compiler == Cache::Compiler::ICC))
+        {
+            bool succeeded = false;
+            info.target    = GetFirstOutputLine(tool + " " + COMP_DUMP_MACHINE, succeeded);
+        }
+
+        if(info.available)
+        {
+            string content = path + "\n" + std::to_string(size) + "\n" + std::to_string(mtime) + "\n" +
+                             Cache::HashFile(path) + "\n" + info.version + "\n" + info.target;
+            info.fingerprint = Cache::HashString(content);
+        }
+    }
+
+    SaveToolchainCache(tools);
+    return info;
+}
+
+ToolInfo ProbeTool(const string &tool)
+{
+    std::lock_guard<std::mutex> lock(probeMut);
+    return GetProbedTool(tool);
+}
+
+bool IsToolAvailable(const string &tool)
+{
+    std::lock_guard<std::mutex> lock(probeMut);
+    return GetProbedTool(tool).available;
+}
+
+bool ToolSupportsFlag(const string &executable, const string &flag)
+{
+    std::lock_guard<std::mutex> lock(probeMut);
+
+    ToolInfo &info = GetProbedTool(executable);
+    if(!info.available)
+        return false;
+
+    // (the flag macros have a trailing space)
+    string key = flag.substr(0, flag.find_last_not_of(' ') + 1);
+
+    auto entry = info.flags.find(key);
+    if(entry != info.flags.end())
+        return entry->second;
+
+    string command = executable + " " + key + " " + COMP_LANG_CPP + COMP_COMPILE_ONLY + YMAKE_NULL_DEVICE + " " +
+                     COMP_OUTPUT_FILE(YMAKE_NULL_DEVICE) + COMP_SUPPRESS_OUTPUT;
+    LTRACE(true, "COMMAND TO PROBE FLAG: \n\t", command, "\n");
+
+    bool supported  = std::system(command.c_str()) == 0;
+    info.flags[key] = supported;
+
+    SaveToolchainCache(GetProbedTools());
+    return supported;
+}
+
+string GetCompilerFingerprint(const string &executable)
+{
+    if(executable.empty())
+        return "";
+
+    return ProbeTool(executable).fingerprint;
+}
+
+} // namespace Y::Build
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include "../cache/cache.h"
+
+#include <map>
+#include <string>
+
+namespace Y::Build {
+
+// what's known about a tool of the toolchain. (compiler, archiver, binutils, ...)
+struct ToolInfo
+{
+    bool available = false; // 'tool --version' runs.
+    std::string path;       // resolved through PATH. (empty if it isn't found)
+    std::string version;    // first line of --version.
+    std::string target;     // target triple. (compilers only, -dumpmachine)
+
+    // the binary, as of the last probe.
+    u64 size  = 0;
+    i64 mtime = 0;
+
+    // hash of the path, binary, version and target. changes when the tool is upgraded.
+    std::string fingerprint;
+
+    std::map<std::string, bool> flags; // flags probed with ToolSupportsFlag.
+};
+
+// probes a tool once and keeps the result in YMakeCache/toolchain.cache.
+// a cached probe is revalidated by stat. (the resolved path, the size and the mtime of the binary) it runs again
+// only when the tool was replaced, otherwise no process is started.
+ToolInfo ProbeTool(const std::string &tool);
+
+// true if 'tool --version' runs.
+bool IsToolAvailable(const std::string &tool);
+
+// true if the compiler accepts 'flag' for a c++ file. (probed once per compiler binary)
+bool ToolSupportsFlag(const std::string &executable, const std::string &flag);
+
+// fingerprint of a compiler. (empty if it isn't set or found)
+std::string GetCompilerFingerprint(const std::string &executable);
+
+} // namespace Y::Build
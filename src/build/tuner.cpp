@@ -0,0 +1,165 @@
+#include "tuner.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace Y::Build {
+
+// reads "some avg10=X" from a /proc/pressure/* file. returns false if the file isn't there.
+bool ReadPressure(const char *path, f64 &avg10)
+{
+    std::ifstream file(path);
+    if(!file.is_open())
+        return false;
+
+    std::string line;
+    while(std::getline(file, line))
+    {
+        std::istringstream iss(line);
+        std::string kind, avg;
+        if(iss >> kind >> avg && kind == "some" && avg.rfind("avg10=", 0) == 0)
+        {
+            avg10 = std::atof(avg.c_str() + 6);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+SystemLoad ReadSystemLoad()
+{
+    SystemLoad load;
+
+#if defined(IPLATFORM_LINUX)
+    // ex: 0.52 0.58 0.59 2/1234 5678
+    std::ifstream loadavg("/proc/loadavg");
+    if(loadavg.is_open())
+    {
+        std::string load1, load5, load15, tasks;
+        loadavg >> load1 >> load5 >> load15 >> tasks;
+        load.loadAvg = std::atof(load1.c_str());
+        load.running = std::strtoul(tasks.c_str(), nullptr, 10);
+    }
+
+    load.hasPressure = ReadPressure("/proc/pressure/cpu", load.cpuPressure);
+    load.hasPressure = ReadPressure("/proc/pressure/memory", load.memPressure) && load.hasPressure;
+    load.hasPressure = ReadPressure("/proc/pressure/io", load.ioPressure) && load.hasPressure;
+#elif !defined(IPLATFORM_WINDOWS)
+    f64 loadavg[1];
+    if(getloadavg(loadavg, 1) == 1)
+        load.loadAvg = loadavg[0];
+#endif
+
+    return load;
+}
+
+JobTuner::JobTuner(ThreadPool &pool, bool enabled) : pool{pool}
+{
+    if(!enabled)
+        return;
+
+#if defined(IPLATFORM_WINDOWS)
+    LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "--jobs=auto is not supported on windows, using a static job count.\n");
+#else
+    monitor = thread([this] { Run(); });
+#endif
+}
+
+JobTuner::~JobTuner()
+{
+    Stop();
+}
+
+void JobTuner::Stop()
+{
+    {
+        unique_lock<mutex> lock(mut);
+        stop = true;
+    }
+    cv.notify_all();
+
+    if(monitor.joinable())
+        monitor.join();
+}
+
+void JobTuner::Run()
+{
+    const usize cores   = GetMaxThreads();
+    const usize maxJobs = pool.GetWorkerCount();
+
+    usize lastCompleted  = pool.GetCompleted();
+    f64 throughput       = 0.0; // jobs per second (smoothed)
+    f64 throughputBefore = 0.0; // before the last increase
+    bool justIncreased   = false;
+
+    auto interval = std::chrono::milliseconds(YMAKE_JOBS_AUTO_INTERVAL_MS);
+
+    while(true)
+    {
+        {
+            unique_lock<mutex> lock(mut);
+            if(cv.wait_for(lock, interval, [this] { return stop; }))
+                return;
+        }
+
+        SystemLoad load = ReadSystemLoad();
+        usize ours      = pool.GetRunning();
+        usize queued    = pool.GetQueued();
+        usize limit     = pool.GetMaxActive();
+
+        usize completed = pool.GetCompleted();
+        f64 sample      = (completed - lastCompleted) / (YMAKE_JOBS_AUTO_INTERVAL_MS / 1000.0);
+        throughput      = (throughput == 0.0) ? sample : (throughput * 0.7 + sample * 0.3);
+        lastCompleted   = completed;
+
+        // load caused by everything other than our compile jobs.
+        f64 total = (load.running > 0) ? static_cast<f64>(load.running) : load.loadAvg;
+        f64 other = (total > ours) ? (total - ours) : 0.0;
+
+        bool overloaded = (other + ours) > cores * 1.25;
+        bool idle       = (other + ours) < cores;
+        if(load.hasPressure)
+        {
+            overloaded = overloaded || load.cpuPressure > YMAKE_JOBS_AUTO_CPU_PRESSURE_HIGH ||
+                         load.memPressure > YMAKE_JOBS_AUTO_MEM_PRESSURE_HIGH ||
+                         load.ioPressure > YMAKE_JOBS_AUTO_IO_PRESSURE_HIGH;
+            idle = idle && load.cpuPressure < YMAKE_JOBS_AUTO_CPU_PRESSURE_LOW &&
+                   load.memPressure < YMAKE_JOBS_AUTO_MEM_PRESSURE_LOW;
+        }
+
+        usize newLimit = limit;
+        if(overloaded && limit > 1)
+        {
+            // back off quickly.
+            newLimit = limit - ((limit / 4 > 1) ? limit / 4 : 1);
+        }
+        else if(justIncreased && throughput < throughputBefore * 0.9)
+        {
+            // the last increase made things slower.
+            newLimit = limit - 1;
+        }
+        else if(idle && queued > 0 && limit < maxJobs)
+        {
+            // ramp up slowly.
+            newLimit         = limit + 1;
+            throughputBefore = throughput;
+        }
+
+        justIncreased = (newLimit > limit);
+
+        if(newLimit != limit)
+        {
+            LTRACE(true, "[jobs=auto] load: ", load.loadAvg, " running: ", load.running, " psi cpu/mem/io: ",
+                   load.cpuPressure, "/", load.memPressure, "/", load.ioPressure, " throughput: ", throughput,
+                   " jobs/s -> jobs: ", limit, " => ", newLimit, "\n");
+            pool.SetMaxActive(newLimit);
+        }
+    }
+}
+
+} // namespace Y::Build
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include "mt.h"
+
+namespace Y::Build {
+
+struct SystemLoad
+{
+    f64 loadAvg   = 0.0; // 1 minute load average.
+    usize running = 0;   // runnable tasks right now. (linux only, 0 otherwise)
+
+    // pressure stall information. ("some avg10", % of time) (linux 4.20+)
+    bool hasPressure = false;
+    f64 cpuPressure  = 0.0;
+    f64 memPressure  = 0.0;
+    f64 ioPressure   = 0.0;
+};
+
+SystemLoad ReadSystemLoad();
+
+// raises/lowers the number of concurrent jobs of a thread pool while it runs (--jobs=auto),
+// based on the system load, PSI and the measured number of finished jobs per second.
+class JobTuner
+{
+    private:
+    ThreadPool &pool;
+
+    thread monitor;
+    mutex mut;
+    condition_variable cv;
+    bool stop = false;
+
+    void Run();
+
+    public:
+    JobTuner(ThreadPool &pool, bool enabled);
+    ~JobTuner();
+
+    void Stop();
+};
+
+} // namespace Y::Build
@@ -0,0 +1,233 @@
+#include "unity.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using std::string;
+using std::vector;
+namespace fs = std::filesystem;
+
+namespace Y::Build {
+
+// average compile time of the files that have history. (used for files that don't)
+f64 GetFallbackSeconds(const vector<string> &files, const std::unordered_map<string, Cache::CompileStats> &history)
+{
+    f64 total   = 0.0;
+    usize count = 0;
+    for(const auto &file : files)
+    {
+        auto entry = history.find(file);
+        if(entry != history.end() && entry->second.seconds > 0.0)
+        {
+            total += entry->second.seconds;
+            count++;
+        }
+    }
+
+    return (count > 0) ? total / count : YMAKE_UNITY_DEFAULT_FILE_SECONDS;
+}
+
+f64 PredictSeconds(const std::unordered_map<string, Cache::CompileStats> &history, const string &file, f64 fallback)
+{
+    auto entry = history.find(file);
+    if(entry == history.end() || entry->second.seconds <= 0.0)
+        return fallback;
+
+    return entry->second.seconds;
+}
+
+void PlanGroup(vector<string> files, const std::unordered_map<string, Cache::CompileStats> &history, f64 fallback,
+               usize jobs, UnityPlan &plan)
+{
+    // nothing to batch.
+    if(files.size() < 2)
+    {
+        for(const auto &file : files)
+            plan.isolated.push_back(file);
+        return;
+    }
+
+    // at least one batch per job (so all cores are busy), at most YMAKE_UNITY_MAX_BATCH_SIZE files per batch,
+    // and at least 2 files per batch.
+    usize count = (files.size() + YMAKE_UNITY_MAX_BATCH_SIZE - 1) / YMAKE_UNITY_MAX_BATCH_SIZE;
+    count       = std::max(count, jobs);
+    count       = std::min(count, files.size() / 2);
+    count       = std::max<usize>(count, 1);
+
+    // longest processing time first: the most expensive file goes to the cheapest batch.
+    std::sort(files.begin(), files.end(), [&](const string &a, const string &b) {
+        f64 costA = PredictSeconds(history, a, fallback);
+        f64 costB = PredictSeconds(history, b, fallback);
+        return (costA != costB) ? costA > costB : a < b;
+    });
+
+    vector<vector<string>> batches(count);
+    vector<f64> load(count, 0.0);
+    for(const auto &file : files)
+    {
+        usize best = count;
+        for(usize i = 0; i < count; i++)
+        {
+            if(batches[i].size() >= YMAKE_UNITY_MAX_BATCH_SIZE)
+                continue;
+            if(best == count || load[i] < load[best])
+                best = i;
+        }
+
+        batches[best].push_back(file);
+        load[best] += PredictSeconds(history, file, fallback);
+    }
+
+    for(auto &batch : batches)
+    {
+        // sorted, so the generated file doesn't change when the order of the costs does.
+        std::sort(batch.begin(), batch.end());
+
+        if(batch.size() == 1)
+            plan.isolated.push_back(batch[0]);
+        else if(!batch.empty())
+            plan.batches.push_back(batch);
+    }
+}
+
+UnityPlan PlanUnityBatches(const vector<string> &files, const vector<string> &excluded,
+                           const std::unordered_map<string, Cache::CompileStats> &history, usize jobs)
+{
+    UnityPlan plan;
+
+    vector<string> cFiles;
+    vector<string> cppFiles;
+    for(const auto &file : files)
+    {
+        if(std::find(excluded.begin(), excluded.end(), file) != excluded.end())
+        {
+            plan.isolated.push_back(file);
+            continue;
+        }
+
+        if(Cache::GetFileType(file) == Cache::FileType::C)
+            cFiles.push_back(file);
+        else
+            cppFiles.push_back(file);
+    }
+
+    f64 fallback = GetFallbackSeconds(files, history);
+    PlanGroup(cFiles, history, fallback, jobs, plan);
+    PlanGroup(cppFiles, history, fallback, jobs, plan);
+
+    return plan;
+}
+
+// format: one file per line -> "<batch index> <workspace path>" ('-' as the index for isolated files)
+UnityPlan LoadUnityPlan(const string &unityDir)
+{
+    UnityPlan plan;
+
+    std::ifstream cacheFile(unityDir + "/" + YMAKE_UNITY_CACHE_FILENAME);
+    if(!cacheFile.is_open())
+        return plan;
+
+    // (the path is the rest of the line, it can have spaces)
+    string line;
+    while(std::getline(cacheFile, line))
+    {
+        usize space = line.find(' ');
+        if(space == string::npos || space + 1 == line.size())
+            continue;
+
+        string index = line.substr(0, space);
+        string path  = Cache::ToAbsolutePath(line.substr(space + 1));
+        if(index == "-")
+        {
+            plan.isolated.push_back(path);
+            continue;
+        }
+
+        if(index.find_first_not_of("0123456789") != string::npos)
+            continue;
+
+        usize batch = std::stoul(index);
+        if(batch >= plan.batches.size())
+            plan.batches.resize(batch + 1);
+        plan.batches[batch].push_back(path);
+    }
+
+    return plan;
+}
+
+void SaveUnityPlan(const string &unityDir, const UnityPlan &plan)
+{
+    if(!Cache::DirExists(unityDir.c_str()))
+        Cache::CreateDir(unityDir.c_str());
+
+    std::ofstream cacheFile(unityDir + "/" + YMAKE_UNITY_CACHE_FILENAME, std::ios::out | std::ios::trunc);
+    if(!cacheFile.is_open())
+    {
+        LLOG(RED_TEXT("[YMAKE ERROR]: "), "couldn't write the unity build cache at: ", unityDir, "\n");
+        throw Y::Error(YERR_FILE_COULDNT_OPEN, "couldn't write the unity build cache.");
+    }
+
+    for(usize i = 0; i < plan.batches.size(); i++)
+    {
+        for(const auto &file : plan.batches[i])
+            cacheFile << i << " " << Cache::ToWorkspacePath(file) << "\n";
+    }
+
+    for(const auto &file : plan.isolated)
+        cacheFile << "- " << Cache::ToWorkspacePath(file) << "\n";
+}
+
+string GetUnityFilePath(const string &unityDir, usize batch, const vector<string> &files)
+{
+    bool isC = !files.empty() && Cache::GetFileType(files[0]) == Cache::FileType::C;
+    return unityDir + "/unity_" + std::to_string(batch) + (isC ? ".c" : ".cpp");
+}
+
+bool WriteUnityFile(const string &path, const vector<string> &files)
+{
+    // (relative to the unity file, so it's the same in every checkout)
+    fs::path dir = fs::path(Cache::ToAbsolutePath(path)).parent_path();
+
+    std::ostringstream content;
+    content << "// generated by ymake (unity build). do not edit.\n";
+    for(const auto &file : files)
+    {
+        string include = fs::path(file).lexically_relative(dir).generic_string();
+        content << "#include \"" << (include.empty() ? file : include) << "\"\n";
+    }
+
+    return Cache::WriteFileIfChanged(path, content.str());
+}
+
+void AttributeUnityStats(const UnityPlan &plan, const string &unityDir,
+                         const std::unordered_map<string, Cache::CompileStats> &history,
+                         std::unordered_map<string, Cache::CompileStats> &compileStats)
+{
+    for(usize i = 0; i < plan.batches.size(); i++)
+    {
+        const auto &batch = plan.batches[i];
+
+        auto batchStats = compileStats.find(GetUnityFilePath(unityDir, i, batch));
+        if(batchStats == compileStats.end())
+            continue;
+
+        f64 fallback = GetFallbackSeconds(batch, history);
+        f64 total    = 0.0;
+        for(const auto &file : batch)
+            total += PredictSeconds(history, file, fallback);
+
+        for(const auto &file : batch)
+        {
+            // keep the file's own peak RSS (from when it was compiled alone), if any.
+            auto entry = history.find(file);
+            u64 peakRSS = (entry != history.end()) ? entry->second.peakRSS : 0;
+
+            f64 share = (total > 0.0) ? PredictSeconds(history, file, fallback) / total : 1.0 / batch.size();
+            compileStats[file] = Cache::CompileStats{peakRSS, batchStats->second.seconds * share};
+        }
+    }
+}
+
+} // namespace Y::Build
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../core/defines.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+
+#include "../cache/cache.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Y::Build {
+
+// how the sources of a project are grouped for a unity (jumbo) build.
+// (saved in YMakeCache/<proj>/unity/unity.cache, so incremental builds keep the same batches)
+struct UnityPlan
+{
+    std::vector<std::vector<std::string>> batches; // files #included together in one translation unit.
+    std::vector<std::string> isolated;             // files compiled on their own. (excluded, new or edited)
+};
+
+// groups files into batches with about the same predicted compile time (longest first, each to the
+// cheapest batch), using the compile times of previous builds. c and c++ files never share a batch.
+// files in 'excluded' are isolated.
+UnityPlan PlanUnityBatches(const std::vector<std::string> &files, const std::vector<std::string> &excluded,
+                           const std::unordered_map<std::string, Cache::CompileStats> &history, usize jobs);
+
+UnityPlan LoadUnityPlan(const std::string &unityDir);
+void SaveUnityPlan(const std::string &unityDir, const UnityPlan &plan);
+
+// path of the generated translation unit of a batch.
+std::string GetUnityFilePath(const std::string &unityDir, usize batch, const std::vector<std::string> &files);
+
+// writes the translation unit of a batch, including the files by their path relative to it. (only if its content
+// changed, so its timestamp stays the same)
+// returns true if the file was (re)written.
+bool WriteUnityFile(const std::string &path, const std::vector<std::string> &files);
+
+// splits the compile time of each batch between its files. (in proportion to their predicted times)
+// so the next plan still has per-file times to work with.
+void AttributeUnityStats(const UnityPlan &plan, const std::string &unityDir,
+                         const std::unordered_map<std::string, Cache::CompileStats> &history,
+                         std::unordered_map<std::string, Cache::CompileStats> &compileStats);
+
+} // namespace Y::Build
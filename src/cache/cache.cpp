@@ -1,4 +1,5 @@
 #include "cache.h"
+#include "toolchain.h"
 
 #include <filesystem>
 namespace fs = std::filesystem;
@@ -141,7 +142,147 @@ std::string ToAbsolutePath(const std::string &path)
     return fs::absolute(path).lexically_normal().string();
 }
 
+std::string GetWorkspaceRoot()
+{
+    return fs::current_path().lexically_normal().string();
+}
+
+std::string ToWorkspacePath(const std::string &path)
+{
+    fs::path absolute = fs::absolute(path).lexically_normal();
+    fs::path relative = absolute.lexically_relative(GetWorkspaceRoot());
+    if(relative.empty() || *relative.begin() == "..")
+        return absolute.string();
+
+    return relative.string();
+}
+
+std::string RelocateCommand(const std::string &command)
+{
+    std::string root = GetWorkspaceRoot();
+    if(root.empty() || root == fs::path(root).root_path().string())
+        return command;
+
+    // (only where the root is a whole path component, /work/a isn't a prefix of /work/ab)
+    std::string relocated;
+    relocated.reserve(command.size());
+    usize pos = 0;
+    while(true)
+    {
+        usize found = command.find(root, pos);
+        if(found == std::string::npos)
+            break;
+
+        usize end = found + root.size();
+        bool component = (end == command.size() || command[end] == '/' || command[end] == '\\' ||
+                          command[end] == ' ' || command[end] == '=' || command[end] == '"');
+
+        relocated.append(command, pos, found - pos);
+        relocated += component ? "." : root;
+        pos = end;
+    }
+    relocated.append(command, pos, std::string::npos);
+
+    return relocated;
+}
+
 // validates if a cache is valid or not based on the timestamp and config filepath
+bool WriteFileIfChanged(const std::string &path, const std::string &content)
+{
+    std::ifstream existing(path);
+    if(existing.is_open())
+    {
+        std::ostringstream old;
+        old << existing.rdbuf();
+        if(old.str() == content)
+            return false;
+    }
+    existing.close();
+
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if(!file.is_open())
+    {
+        LLOG(RED_TEXT("[YMAKE ERROR]: "), "couldn't write file: ", path, "\n");
+        throw Y::Error(YERR_FILE_COULDNT_OPEN, "couldn't write a generated file.");
+    }
+
+    file << content;
+    return true;
+}
+
+std::string HashString(const std::string &data)
+{
+    u64 hash = 14695981039346656037ull;
+    for(unsigned char c : data)
+    {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+
+    std::ostringstream oss;
+    oss << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return oss.str();
+}
+
+std::string HashFile(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::ostringstream oss;
+    oss << file.rdbuf();
+    return HashString(oss.str());
+}
+
+std::vector<std::string> ParseDepFile(const std::string &path)
+{
+    std::vector<std::string> deps;
+
+    std::ifstream depFile(path);
+    if(!depFile.is_open())
+        return deps;
+
+    std::ostringstream buff;
+    buff << depFile.rdbuf();
+    std::string content = buff.str();
+
+    // format: "target: dep1 dep2 ..." (lines continue with a trailing backslash, spaces in paths are escaped)
+    usize colon = content.find(": ");
+    if(colon == std::string::npos)
+        return deps;
+
+    std::string dep;
+    for(usize i = colon + 1; i < content.size(); i++)
+    {
+        char c = content[i];
+        if(c == '\\' && i + 1 < content.size() && (content[i + 1] == ' ' || content[i + 1] == '#'))
+        {
+            dep += content[++i];
+        }
+        else if(c == '\\' && i + 1 < content.size() && (content[i + 1] == '\n' || content[i + 1] == '\r'))
+        {
+            i++;
+        }
+        else if(c == ' ' || c == '\t' || c == '\n' || c == '\r')
+        {
+            if(!dep.empty())
+                deps.push_back(dep);
+            dep.clear();
+
+            // only the first rule. (-MP adds empty rules for each header)
+            if(c == '\n' && i + 1 < content.size() && content[i + 1] != ' ' && content[i + 1] != '\t')
+                break;
+        }
+        else
+        {
+            dep += c;
+        }
+    }
+
+    if(!dep.empty())
+        deps.push_back(dep);
+
+    return deps;
+}
+
 bool IsConfigCacheValid(const char *configFilePath)
 {
     LTRACE(true, "checking if cache is valid...\n");
@@ -413,7 +554,7 @@ bool HasFileChanged(const std::string &filepath, const FileMetadata &cachedMetad
     return (currentLastWriteTime != cachedMetadata.lastWriteTime || currentFileSize != cachedMetadata.fileSize);
 }
 
-void SaveMetadataCache(const std::string &filepath, const std::unordered_map<std::string, FileMetadata> &metadataCache)
+void SaveMetadataCache(const std::string &filepath, const PathMap<FileMetadata> &metadataCache)
 {
     std::ofstream cacheFile(filepath);
     if(!cacheFile.is_open())
@@ -425,10 +566,10 @@ void SaveMetadataCache(const std::string &filepath, const std::unordered_map<std
     LTRACE(true, "saving metadata cache to disk...\n");
 
     // add data to the file.
-    for(auto &[path, data] : metadataCache)
-    {
-        cacheFile << ToAbsolutePath(path) << " " << data.lastWriteTime << " " << data.fileSize << "\n";
-    }
+    metadataCache.ForEach([&cacheFile](PathId path, const FileMetadata &data) {
+        cacheFile << ToWorkspacePath(GetInternedPath(path)) << " " << data.lastWriteTime << " " << data.fileSize
+                  << "\n";
+    });
 
     LTRACE(true, "successfully created metadata cache at path: ", filepath, "\n");
 
@@ -449,7 +590,8 @@ void CreateMetadataCache(const std::vector<std::string> files, std::string dir)
         LLOG(RED_TEXT("[YMAKE ERROR]: "), "couldn't create cache directories.\n\t", err.what(), "\n");
     }
 
-    std::unordered_map<std::string, FileMetadata> metadata;
+    PathMap<FileMetadata> metadata;
+    metadata.Reserve(files.size());
 
     // load data.
     for(const auto &file : files)
@@ -457,7 +599,7 @@ void CreateMetadataCache(const std::vector<std::string> files, std::string dir)
         auto currentLastWriteTime = GetTimeSinceLastWrite(file.c_str());
         auto currentFileSize      = fs::file_size(file);
 
-        metadata[file] = FileMetadata{currentLastWriteTime, currentFileSize};
+        metadata[InternPath(file)] = FileMetadata{currentLastWriteTime, currentFileSize};
     }
 
     LTRACE(true, "created metadata cache (in program) successfully.\n");
@@ -475,11 +617,11 @@ void CreateMetadataCache(const std::vector<std::string> files, std::string dir)
     }
 }
 
-std::unordered_map<std::string, FileMetadata> LoadMetadataCache(const std::string &cacheFilepath)
+PathMap<FileMetadata> LoadMetadataCache(const std::string &cacheFilepath)
 {
     LTRACE(true, "trying to load metadata cache from disk...\n");
 
-    std::unordered_map<std::string, FileMetadata> metadataCache;
+    PathMap<FileMetadata> metadataCache;
 
     if(!fs::exists(cacheFilepath.c_str()))
     {
@@ -503,7 +645,7 @@ std::unordered_map<std::string, FileMetadata> LoadMetadataCache(const std::strin
         FileMetadata metadata;
         if(iss >> filepath >> metadata.lastWriteTime >> metadata.fileSize)
         {
-            metadataCache[filepath.c_str()] = metadata;
+            metadataCache[InternPath(filepath)] = metadata;
         }
     }
 
@@ -515,7 +657,7 @@ std::unordered_map<std::string, FileMetadata> LoadMetadataCache(const std::strin
 void UpdateMetadataCache(const std::string &file, const char *projCacheDir)
 {
     std::string cachefilepath = std::string(projCacheDir) + "/" + YMAKE_METADATA_CACHE_FILENAME;
-    std::map<std::string, FileMetadata> cacheData;
+    PathMap<FileMetadata> cacheData;
 
     // Load existing cache data
     std::ifstream cachefile_in(cachefilepath);
@@ -523,13 +665,14 @@ void UpdateMetadataCache(const std::string &file, const char *projCacheDir)
     {
         std::string filepath;
         u64 filesize;
-        std::string writeTime;
+        std::time_t writeTime;
         while(cachefile_in >> filepath >> writeTime >> filesize)
         {
+            // NOTE: stored as a number (like in CreateMetadataCache), not as a formatted timestamp.
             FileMetadata fm;
-            fm.lastWriteTime    = ToTimeT(writeTime);
-            fm.fileSize         = filesize;
-            cacheData[filepath] = fm;
+            fm.lastWriteTime                = writeTime;
+            fm.fileSize                     = filesize;
+            cacheData[InternPath(filepath)] = fm;
         }
         cachefile_in.close();
     }
@@ -537,8 +680,8 @@ void UpdateMetadataCache(const std::string &file, const char *projCacheDir)
     // Update or add the new file data
     FileMetadata fm;
     fm.lastWriteTime = GetTimeSinceLastWrite(file.c_str());
-    fm.fileSize      = GetFileSize(file.c_str());
-    cacheData[file]  = fm;
+    fm.fileSize                 = GetFileSize(file.c_str());
+    cacheData[InternPath(file)] = fm;
 
     // Write the updated cache data back to the file
     std::ofstream cachefile_out(cachefilepath, std::ios::out | std::ios::trunc);
@@ -548,15 +691,47 @@ void UpdateMetadataCache(const std::string &file, const char *projCacheDir)
         throw Y::Error("couldn't create a metadata cache file.\n");
     }
 
-    for(const auto &entry : cacheData)
+    cacheData.ForEach([&cachefile_out](PathId path, const FileMetadata &data) {
+        cachefile_out << ToWorkspacePath(GetInternedPath(path)) << " " << data.lastWriteTime << " " << data.fileSize
+                      << "\n";
+    });
+
+    cachefile_out.close();
+}
+
+// removes the entries of the given files, so they are recompiled in the next build.
+void RemoveFromMetadataCache(const std::vector<std::string> &files, const char *projCacheDir)
+{
+    std::string cachefilepath = std::string(projCacheDir) + "/" + YMAKE_METADATA_CACHE_FILENAME;
+    PathMap<std::pair<std::string, u64>> cacheData;
+
+    std::ifstream cachefile_in(cachefilepath);
+    if(!cachefile_in.is_open())
+        return;
+
+    std::string filepath;
+    u64 filesize;
+    std::string writeTime;
+    while(cachefile_in >> filepath >> writeTime >> filesize)
+        cacheData[InternPath(filepath)] = {writeTime, filesize};
+    cachefile_in.close();
+
+    for(const auto &file : files)
+        cacheData.Erase(InternPath(file));
+
+    std::ofstream cachefile_out(cachefilepath, std::ios::out | std::ios::trunc);
+    if(!cachefile_out.is_open())
     {
-        cachefile_out << entry.first << " " << entry.second.lastWriteTime << " " << entry.second.fileSize << "\n";
+        LLOG(RED_TEXT("[YMAKE ERROR]: "), "couldn't update the metadata cache file.\n");
+        throw Y::Error("couldn't update the metadata cache file.\n");
     }
 
-    cachefile_out.close();
+    cacheData.ForEach([&cachefile_out](PathId path, const std::pair<std::string, u64> &data) {
+        cachefile_out << ToWorkspacePath(GetInternedPath(path)) << " " << data.first << " " << data.second << "\n";
+    });
 }
 
-bool HasSourceFileChanged(const char *path, std::unordered_map<std::string, FileMetadata> &metadataCache)
+bool HasSourceFileChanged(const char *path, const PathMap<FileMetadata> &metadataCache)
 {
     std::ifstream file(path);
     if(!file.is_open())
@@ -565,8 +740,9 @@ bool HasSourceFileChanged(const char *path, std::unordered_map<std::string, File
         return true;
     }
 
-    if(GetFileSize(path) != metadataCache[path].fileSize ||
-       GetTimeSinceLastWrite(path) != metadataCache[path].lastWriteTime)
+    const FileMetadata *cached = metadataCache.Find(InternPath(path));
+    if(cached == nullptr || GetFileSize(path) != cached->fileSize ||
+       GetTimeSinceLastWrite(path) != cached->lastWriteTime)
         return true;
 
     return false;
@@ -609,7 +785,8 @@ std::vector<std::string> GetSrcFilesRecursive(const std::string &dirPath)
         if(entry.is_regular_file())
         {
             std::string ext = entry.path().extension().string();
-            if(ext == ".c" || ext == ".cpp" || ext == ".cc" || ext == ".cxx")
+            if(ext == ".c" || ext == ".cpp" || ext == ".cc" || ext == ".cxx" ||
+               IsModuleInterfaceFile(entry.path().string()))
             {
                 files.push_back(ToAbsolutePath(entry.path().string()));
             }
@@ -675,7 +852,7 @@ FileType GetFileType(const string &filepath)
         return FileType::C;
 
     if(extension == ".cpp" || extension == ".cxx" || extension == ".cc" || extension == ".c++" || extension == ".cp" ||
-       extension == ".cxx" || extension == ".tpp")
+       extension == ".cxx" || extension == ".tpp" || IsModuleInterfaceFile(path))
         return FileType::CPP;
 
     if(extension == ".h" || extension == ".hpp" || extension == ".hxx" || extension == ".h++" || extension == ".hh")
@@ -690,6 +867,13 @@ FileType GetFileType(const string &filepath)
     return FileType::UNKOWN;
 }
 
+bool IsModuleInterfaceFile(const string &filepath)
+{
+    string extension = ToLower(fs::path(filepath).extension().string());
+    return extension == ".cppm" || extension == ".ixx" || extension == ".mpp" || extension == ".cxxm" ||
+           extension == ".ccm" || extension == ".c++m";
+}
+
 string Basename(string fullpath)
 {
     fs::path path(fullpath);
@@ -702,11 +886,10 @@ string Basepath(string fullpath)
     return path.parent_path().string();
 }
 
-string GetHashedFileNameFromPath(const string &file)
+string GetShardedCachePath(const string &dir, const string &file, const string &ext)
 {
-    std::hash<string> hasher;
-    usize hashValue = hasher(file);
-    return Basename(file) + "_" + std::to_string(hashValue);
+    string hash = HashString(ToWorkspacePath(file));
+    return dir + "/" + hash.substr(0, 2) + "/" + Basename(file) + "_" + hash + ext;
 }
 
 // takes a /path/to/base.c -> /new/path/base.i
@@ -728,28 +911,32 @@ std::string PreprocessUnit(const Project &proj, const std::string &file, const s
         command += std::string(proj.cppCompiler) + " ";
     }
 
+    const Toolchain &toolchain = GetToolchain(compiler);
+
     // add -E flag and file to preprocess.
-    command +=
-        (compiler == Compiler::MSVC) ? std::string(COMP_MSVC_PREPROCESS_ONLY) : std::string(COMP_PREPROCESS_ONLY);
+    command += toolchain.preprocessOnly;
+
+    // gcc doesn't know the module interface extensions.
+    if(compiler == Compiler::GCC && IsModuleInterfaceFile(file))
+        command += COMP_LANG_CPP;
     command += std::string(file) + " ";
 
     // output file.
-    fs::path inputPath(file);
+    std::string outputPath = GetShardedCachePath(path + "/src", file, ".i");
 
-    std::string outputPath = path + "/src" + "/" + GetHashedFileNameFromPath(file);
-    outputPath += std::string(".i");
+    std::error_code ec;
+    fs::create_directories(fs::path(outputPath).parent_path(), ec);
 
     LTRACE(true, "about to create preprocessed cache at: ", outputPath, "\n");
 
-    command += (compiler == Compiler::MSVC) ? COMP_MSVC_OUTPUT_FILE(outputPath) : COMP_OUTPUT_FILE(outputPath);
+    Toolchain::Append(command, toolchain.output, outputPath);
 
     // add includes
-    for(auto include : proj.includeDirs)
-        command +=
-            (compiler == Compiler::MSVC) ? COMP_MSVC_INCLUDE_DIR(include.c_str()) : COMP_INCLUDE_DIR(include.c_str());
+    for(const auto &include : proj.includeDirs)
+        Toolchain::Append(command, toolchain.includeDir, include);
 
     // supress output.
-    command += (compiler == Compiler::MSVC) ? COMP_MSVC_SUPPRESS_OUTPUT : COMP_SUPPRESS_OUTPUT;
+    command += toolchain.suppressOutput;
 
     i32 result = std::system(command.c_str());
     LASSERT(result == 0, RED_TEXT("[YMAKE COMPILE ERROR]: "), "failed to compile source file: ", file, "\n\t",
@@ -777,7 +964,7 @@ void CreatePreprocessedCache(const std::vector<std::string> &files, const char *
     // load data into file.
     for(const auto &file : files)
     {
-        cachefile << file << " " << Cache::GetFileSize(file.c_str()) << "\n";
+        cachefile << ToWorkspacePath(file) << " " << Cache::GetFileSize(file.c_str()) << "\n";
     }
 
     cachefile.close();
@@ -786,7 +973,7 @@ void CreatePreprocessedCache(const std::vector<std::string> &files, const char *
 void UpdatePreprocessedCache(const std::string &file, const char *projCacheDir)
 {
     std::string cachefilepath = std::string(projCacheDir) + "/" + YMAKE_PREPROCESS_CACHE_FILENAME;
-    std::map<std::string, u64> cacheData;
+    PathMap<u64> cacheData;
 
     // Load existing cache data
     std::ifstream cachefile_in(cachefilepath);
@@ -796,13 +983,13 @@ void UpdatePreprocessedCache(const std::string &file, const char *projCacheDir)
         u64 filesize;
         while(cachefile_in >> filepath >> filesize)
         {
-            cacheData[filepath] = filesize;
+            cacheData[InternPath(filepath)] = filesize;
         }
         cachefile_in.close();
     }
 
     // Update or add the new file data
-    cacheData[file] = Cache::GetFileSize(file.c_str());
+    cacheData[InternPath(file)] = Cache::GetFileSize(file.c_str());
 
     // Write the updated cache data back to the file
     std::ofstream cachefile_out(cachefilepath, std::ios::out | std::ios::trunc);
@@ -812,16 +999,15 @@ void UpdatePreprocessedCache(const std::string &file, const char *projCacheDir)
         throw Y::Error("couldn't create a metadata cache file.\n");
     }
 
-    for(const auto &entry : cacheData)
-    {
-        cachefile_out << entry.first << " " << entry.second << "\n";
-    }
+    cacheData.ForEach([&cachefile_out](PathId path, u64 filesize) {
+        cachefile_out << ToWorkspacePath(GetInternedPath(path)) << " " << filesize << "\n";
+    });
 
     cachefile_out.close();
 }
 
-// returns a map of <filepath, filesize>
-std::map<std::string, u64> LoadPreprocessedCache(const char *projCacheDir)
+// returns a map of <interned filepath, filesize>
+PathMap<u64> LoadPreprocessedCache(const char *projCacheDir)
 {
     if(!Cache::DirExists(projCacheDir))
         throw Y::Error("couldn't load a cache file... project cache directory doesn't exist");
@@ -835,7 +1021,7 @@ std::map<std::string, u64> LoadPreprocessedCache(const char *projCacheDir)
         throw Y::Error("couldn't open a metadata cache files.\n");
     }
 
-    std::map<std::string, u64> files;
+    PathMap<u64> files;
     std::string line;
     while(std::getline(cachefile, line))
     {
@@ -844,7 +1030,7 @@ std::map<std::string, u64> LoadPreprocessedCache(const char *projCacheDir)
         u64 filesize;
         if(iss >> path >> filesize)
         {
-            files[path] = filesize;
+            files[InternPath(path)] = filesize;
         }
     }
 
@@ -880,4 +1066,88 @@ std::vector<std::string> GeneratePreprocessedFiles(const Project &proj, const st
 
     return compiledFiles;
 }
+
+//_______________________________ COMPILE STATS (HISTORY) CACHE ____________________
+
+// format: one file per line -> "<peak RSS in KB> <seconds> <src workspace path>"
+std::unordered_map<std::string, CompileStats> LoadCompileStatsCache(const char *projCacheDir)
+{
+    std::unordered_map<std::string, CompileStats> stats;
+
+    std::string cachefilepath = std::string(projCacheDir) + "/" + YMAKE_COMPILE_STATS_CACHE_FILENAME;
+    std::ifstream cachefile(cachefilepath);
+    if(!cachefile.is_open())
+    {
+        LTRACE(true, "no compile stats cache found at: ", cachefilepath, "\n");
+        return stats;
+    }
+
+    std::string line;
+    while(std::getline(cachefile, line))
+    {
+        // (the path is the rest of the line, it can have spaces)
+        std::istringstream iss(line);
+        std::string path;
+        CompileStats entry;
+        if(iss >> entry.peakRSS >> entry.seconds && iss.get() == ' ' && std::getline(iss, path) && !path.empty())
+        {
+            stats[ToAbsolutePath(path)] = entry;
+        }
+    }
+
+    return stats;
+}
+
+void SaveCompileStatsCache(const char *projCacheDir, const std::unordered_map<std::string, CompileStats> &stats)
+{
+    Cache::CreateDir(projCacheDir);
+
+    std::string cachefilepath = std::string(projCacheDir) + "/" + YMAKE_COMPILE_STATS_CACHE_FILENAME;
+    std::ofstream cachefile(cachefilepath, std::ios::out | std::ios::trunc);
+    if(!cachefile.is_open())
+    {
+        LLOG(RED_TEXT("[YMAKE ERROR]: "), "couldn't save compile stats to file: ", cachefilepath, "\n");
+        return;
+    }
+
+    for(const auto &[path, entry] : stats)
+    {
+        cachefile << entry.peakRSS << " " << entry.seconds << " " << ToWorkspacePath(path) << "\n";
+    }
+
+    cachefile.close();
+}
+
+// format: one object per line -> "<command key> <object workspace path>"
+PathMap<std::string> LoadObjectCommandsCache(const std::string &objectDir)
+{
+    PathMap<std::string> commandKeys;
+
+    std::ifstream cachefile(objectDir + "/" + YMAKE_COMMANDS_CACHE_FILENAME);
+    std::string line;
+    while(std::getline(cachefile, line))
+    {
+        usize space = line.find(' ');
+        if(space != std::string::npos)
+            commandKeys[InternPath(line.substr(space + 1))] = line.substr(0, space);
+    }
+
+    return commandKeys;
+}
+
+void SaveObjectCommandsCache(const std::string &objectDir, const PathMap<std::string> &commandKeys)
+{
+    std::string cachefilepath = objectDir + "/" + YMAKE_COMMANDS_CACHE_FILENAME;
+    std::ofstream cachefile(cachefilepath, std::ios::out | std::ios::trunc);
+    if(!cachefile.is_open())
+    {
+        LLOG(RED_TEXT("[YMAKE ERROR]: "), "couldn't save the object commands to file: ", cachefilepath, "\n");
+        return;
+    }
+
+    commandKeys.ForEach([&cachefile](PathId object, const std::string &key) {
+        cachefile << key << " " << ToWorkspacePath(GetInternedPath(object)) << "\n";
+    });
+}
+
 } // namespace Y::Cache
\ No newline at end of file
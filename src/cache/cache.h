@@ -6,6 +6,8 @@
 
 #include "../toml/parser.h"
 
+#include "paths.h"
+
 #include <unordered_map>
 
 namespace Y::Cache {
@@ -31,6 +33,34 @@ std::string ConcatenatePath(const std::string &basePath, const std::string &rela
 
 std::string ToAbsolutePath(const std::string &path);
 
+// the directory ymake runs in. (where the config file is)
+std::string GetWorkspaceRoot();
+
+// a path as the cache records it: relative to the workspace root, so the cache of a checkout still applies when it
+// is moved or cloned elsewhere. paths outside of the workspace stay absolute.
+std::string ToWorkspacePath(const std::string &path);
+
+// a command with the workspace root replaced by '.', for keys that must be the same in every checkout.
+std::string RelocateCommand(const std::string &command);
+
+// writes a (generated) file only if its content changed, so its timestamp stays the same.
+// returns true if the file was (re)written.
+bool WriteFileIfChanged(const std::string &path, const std::string &content);
+
+// stable 64-bit hash (FNV-1a) as 16 hex digits. the same on every platform and build of ymake, so it can name and
+// key what's kept in the cache. (unlike std::hash)
+std::string HashString(const std::string &data);
+
+// hash of a file's content. (empty file if it doesn't exist)
+std::string HashFile(const std::string &path);
+
+// where the cached output of a source goes: dir/<first 2 digits of the hash>/file_<hash><ext>
+// (256 sub-directories, a directory doesn't end up with every object of a large project)
+std::string GetShardedCachePath(const std::string &dir, const std::string &file, const std::string &ext);
+
+// dependencies listed in a make-style depfile (as generated by -MD). empty if it doesn't exist.
+std::vector<std::string> ParseDepFile(const std::string &path);
+
 bool IsConfigCacheValid(const char *configFilePath);
 
 // creates the cache. (overrites any existing cache files)
@@ -51,12 +81,14 @@ struct FileMetadata
 };
 
 bool HasFileChanged(const std::string &filepath, const FileMetadata &cachedMetadata);
-bool HasSourceFileChanged(const char *path, const std::unordered_map<std::string, FileMetadata> &metadataCache);
+bool HasSourceFileChanged(const char *path, const PathMap<FileMetadata> &metadataCache);
 
 void CreateMetadataCache(const std::vector<std::string> files, std::string projectName);
 
-std::unordered_map<std::string, FileMetadata> LoadMetadataCache(const std::string &cacheFileath);
+// keyed by the interned (absolute) path of each file.
+PathMap<FileMetadata> LoadMetadataCache(const std::string &cacheFileath);
 void UpdateMetadataCache(const std::string &file, const char *projCacheDir);
+void RemoveFromMetadataCache(const std::vector<std::string> &files, const char *projCacheDir);
 
 // get (.c or .cpp or .cc) files recursively. (outputs absolut path.)
 std::vector<std::string> GetSrcFilesRecursive(const std::string &dirPath);
@@ -89,15 +121,38 @@ enum class FileType
 Compiler WhatCompiler(const std::string &compiler);
 FileType GetFileType(const std::string &filepath);
 
+// .cppm, .ixx, ... (c++20 module interface units, compiled as c++)
+bool IsModuleInterfaceFile(const std::string &filepath);
+
 std::string PreprocessUnit(const Project &proj, const std::string &file, const std::string &path);
 
 void CreatePreprocessedCache(const std::vector<std::string> &files, const char *projCacheDir);
 
 void UpdatePreprocessedCache(const std::string &file, const char *projCacheDir);
 
-std::map<std::string, u64> LoadPreprocessedCache(const char *projCacheDir);
+PathMap<u64> LoadPreprocessedCache(const char *projCacheDir);
 
 std::vector<std::string> GeneratePreprocessedFiles(const Project &proj, const std::vector<std::string> &files,
                                                    const char *path);
 
+//_______________________________ COMPILE STATS (HISTORY) CACHE ____________________
+
+struct CompileStats
+{
+    u64 peakRSS; // in KB
+    f64 seconds;
+};
+
+// returns a map of <src filepath, stats from the last compile>
+std::unordered_map<std::string, CompileStats> LoadCompileStatsCache(const char *projCacheDir);
+
+void SaveCompileStatsCache(const char *projCacheDir, const std::unordered_map<std::string, CompileStats> &stats);
+
+//_______________________________ OBJECT COMMANDS CACHE ____________________
+
+// returns a map of <interned object path, key of the command it was compiled with> (objectDir/commands.cache)
+PathMap<std::string> LoadObjectCommandsCache(const std::string &objectDir);
+
+void SaveObjectCommandsCache(const std::string &objectDir, const PathMap<std::string> &commandKeys);
+
 } // namespace Y::Cache
\ No newline at end of file
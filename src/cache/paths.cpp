@@ -0,0 +1,135 @@
+#include "paths.h"
+#include "cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace Y::Cache {
+
+// characters per block. (a longer path gets a block of its own)
+static const usize pathBlockSize = 64 * 1024;
+
+std::string_view PathInterner::Store(std::string_view str)
+{
+    if(blocks.empty() || blockUsed + str.size() > pathBlockSize)
+    {
+        blocks.push_back(std::make_unique<char[]>(std::max(pathBlockSize, str.size())));
+        blockUsed = 0;
+    }
+
+    char *dest = blocks.back().get() + blockUsed;
+    std::memcpy(dest, str.data(), str.size());
+    blockUsed += str.size();
+
+    return std::string_view(dest, str.size());
+}
+
+u32 PathInterner::FindEntry(std::string_view spelling, usize hash) const
+{
+    if(table.empty())
+        return 0;
+
+    usize mask = table.size() - 1;
+    for(usize i = hash & mask; table[i] != 0; i = (i + 1) & mask)
+    {
+        const Entry &entry = entries[table[i] - 1];
+        if(entry.hash == hash && entry.spelling == spelling)
+            return table[i];
+    }
+
+    return 0;
+}
+
+void PathInterner::AddEntry(std::string_view spelling, usize hash, PathId id)
+{
+    // (at most half full, rehashed from the stored hashes)
+    if((entries.size() + 1) * 2 > table.size())
+    {
+        table.assign(table.empty() ? 1024 : table.size() * 2, 0);
+        usize mask = table.size() - 1;
+        for(u32 e = 0; e < entries.size(); e++)
+        {
+            usize i = entries[e].hash & mask;
+            while(table[i] != 0)
+                i = (i + 1) & mask;
+            table[i] = e + 1;
+        }
+    }
+
+    entries.push_back(Entry{spelling, hash, id});
+
+    usize mask = table.size() - 1;
+    usize i    = hash & mask;
+    while(table[i] != 0)
+        i = (i + 1) & mask;
+    table[i] = static_cast<u32>(entries.size());
+}
+
+PathId PathInterner::InternNormalized(std::string_view path)
+{
+    usize hash = std::hash<std::string_view>{}(path);
+    if(u32 entry = FindEntry(path, hash))
+        return entries[entry - 1].id;
+
+    if(paths.size() >= YMAKE_INVALID_PATH_ID)
+        throw Y::Error("too many paths in the build.");
+
+    PathId id              = static_cast<PathId>(paths.size());
+    std::string_view saved = Store(path);
+    paths.push_back(saved);
+    AddEntry(saved, hash, id);
+
+    return id;
+}
+
+PathId PathInterner::Intern(std::string_view path)
+{
+    std::lock_guard<std::mutex> lock(mut);
+
+    usize hash = std::hash<std::string_view>{}(path);
+    if(u32 entry = FindEntry(path, hash))
+        return entries[entry - 1].id;
+
+    // a new spelling. (it's an alias if it isn't normal)
+    std::string normalized = ToAbsolutePath(std::string(path));
+    PathId id              = InternNormalized(normalized);
+    if(normalized != path)
+        AddEntry(Store(path), hash, id);
+
+    return id;
+}
+
+PathId PathInterner::Find(std::string_view path) const
+{
+    std::lock_guard<std::mutex> lock(mut);
+
+    u32 entry = FindEntry(path, std::hash<std::string_view>{}(path));
+    if(entry != 0)
+        return entries[entry - 1].id;
+
+    // (another spelling of an interned path)
+    std::string normalized = ToAbsolutePath(std::string(path));
+    entry                  = FindEntry(normalized, std::hash<std::string_view>{}(normalized));
+    return (entry != 0) ? entries[entry - 1].id : YMAKE_INVALID_PATH_ID;
+}
+
+std::string_view PathInterner::Get(PathId id) const
+{
+    std::lock_guard<std::mutex> lock(mut);
+    return (id < paths.size()) ? paths[id] : std::string_view();
+}
+
+usize PathInterner::Size() const
+{
+    std::lock_guard<std::mutex> lock(mut);
+    return paths.size();
+}
+
+PathInterner &GetPathInterner()
+{
+    static PathInterner interner;
+    return interner;
+}
+
+} // namespace Y::Cache
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "../core/defines.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Y::Cache {
+
+// a path known to the build, as a 32-bit id. (the same id for every spelling of the path)
+using PathId = u32;
+
+#define YMAKE_INVALID_PATH_ID 0xFFFFFFFFu
+
+// every path the build looks up, stored once. a path is normalized (absolute, lexically normal) the first time one
+// of its spellings is interned, then the spelling maps to the id of the normalized path without touching the
+// filesystem again. the characters live in fixed-size blocks that never move, so Get stays valid for the whole run.
+class PathInterner
+{
+    private:
+    struct Entry
+    {
+        std::string_view spelling;
+        usize hash;
+        PathId id;
+    };
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    usize blockUsed = 0;
+
+    std::vector<std::string_view> paths; // id -> normalized path.
+    std::vector<Entry> entries;          // every spelling seen. (normalized paths included)
+    std::vector<u32> table;              // open addressing, indices into entries. (+1, 0 is an empty slot)
+
+    mutable std::mutex mut;
+
+    std::string_view Store(std::string_view str);
+    u32 FindEntry(std::string_view spelling, usize hash) const;
+    void AddEntry(std::string_view spelling, usize hash, PathId id);
+    PathId InternNormalized(std::string_view path);
+
+    public:
+    PathId Intern(std::string_view path);
+
+    // YMAKE_INVALID_PATH_ID if no spelling of the path was interned.
+    PathId Find(std::string_view path) const;
+
+    std::string_view Get(PathId id) const;
+    usize Size() const;
+};
+
+// the interner of the build. (thread safe)
+PathInterner &GetPathInterner();
+
+inline PathId InternPath(std::string_view path)
+{
+    return GetPathInterner().Intern(path);
+}
+
+inline std::string GetInternedPath(PathId id)
+{
+    return std::string(GetPathInterner().Get(id));
+}
+
+// open addressing hash map keyed by path id. (linear probing, no per-entry allocation, erased slots are filled by
+// shifting the following entries back)
+template <typename V>
+class PathMap
+{
+    private:
+    struct Slot
+    {
+        PathId key = YMAKE_INVALID_PATH_ID;
+        V value{};
+    };
+
+    std::vector<Slot> slots;
+    usize count = 0;
+
+    // (ids are sequential, fibonacci hashing spreads them over the table)
+    usize Home(PathId id) const
+    {
+        return static_cast<usize>((static_cast<u64>(id) * 11400714819323198485ull) >> 32) & (slots.size() - 1);
+    }
+
+    void Grow()
+    {
+        std::vector<Slot> old = std::move(slots);
+        slots.assign(old.empty() ? 16 : old.size() * 2, Slot{});
+        count = 0;
+
+        for(Slot &slot : old)
+        {
+            if(slot.key != YMAKE_INVALID_PATH_ID)
+                (*this)[slot.key] = std::move(slot.value);
+        }
+    }
+
+    public:
+    usize Size() const
+    {
+        return count;
+    }
+
+    bool Empty() const
+    {
+        return count == 0;
+    }
+
+    void Reserve(usize entries)
+    {
+        while(slots.size() * 3 < entries * 4)
+            Grow();
+    }
+
+    V *Find(PathId id)
+    {
+        if(slots.empty())
+            return nullptr;
+
+        for(usize i = Home(id);; i = (i + 1) & (slots.size() - 1))
+        {
+            if(slots[i].key == id)
+                return &slots[i].value;
+            if(slots[i].key == YMAKE_INVALID_PATH_ID)
+                return nullptr;
+        }
+    }
+
+    const V *Find(PathId id) const
+    {
+        return const_cast<PathMap *>(this)->Find(id);
+    }
+
+    bool Contains(PathId id) const
+    {
+        return Find(id) != nullptr;
+    }
+
+    V &operator[](PathId id)
+    {
+        // (at most 3/4 full)
+        if((count + 1) * 4 > slots.size() * 3)
+            Grow();
+
+        usize i = Home(id);
+        while(slots[i].key != YMAKE_INVALID_PATH_ID && slots[i].key != id)
+            i = (i + 1) & (slots.size() - 1);
+
+        if(slots[i].key == YMAKE_INVALID_PATH_ID)
+        {
+            slots[i].key = id;
+            count++;
+        }
+
+        return slots[i].value;
+    }
+
+    bool Erase(PathId id)
+    {
+        if(slots.empty())
+            return false;
+
+        usize mask = slots.size() - 1;
+        usize i    = Home(id);
+        while(slots[i].key != id)
+        {
+            if(slots[i].key == YMAKE_INVALID_PATH_ID)
+                return false;
+            i = (i + 1) & mask;
+        }
+
+        // moves back the entries that would no longer be found past the hole.
+        for(usize j = (i + 1) & mask; slots[j].key != YMAKE_INVALID_PATH_ID; j = (j + 1) & mask)
+        {
+            usize home = Home(slots[j].key);
+            if(((j - home) & mask) >= ((j - i) & mask))
+            {
+                slots[i] = std::move(slots[j]);
+                i        = j;
+            }
+        }
+
+        slots[i] = Slot{};
+        count--;
+        return true;
+    }
+
+    // f(PathId, V &) for every entry. (in no particular order)
+    template <typename F>
+    void ForEach(F &&f)
+    {
+        for(Slot &slot : slots)
+        {
+            if(slot.key != YMAKE_INVALID_PATH_ID)
+                f(slot.key, slot.value);
+        }
+    }
+
+    template <typename F>
+    void ForEach(F &&f) const
+    {
+        for(const Slot &slot : slots)
+        {
+            if(slot.key != YMAKE_INVALID_PATH_ID)
+                f(slot.key, slot.value);
+        }
+    }
+};
+
+} // namespace Y::Cache
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "../core/defines.h"
+
+#include "cache.h"
+
+#include <array>
+#include <string>
+#include <string_view>
+
+namespace Y::Cache {
+
+// flag spellings of a compiler family, known at compile time.
+// prefixes (output, includeDir, ...) are followed by their value and a space, the others have a trailing space.
+// an empty prefix in cStandard means the toolchain has no such flag. (it's skipped)
+// gcc, clang, icc and anything that takes the gcc command line.
+template <Compiler>
+struct ToolchainTraits
+{
+    static constexpr std::string_view compileOnly         = COMP_COMPILE_ONLY;
+    static constexpr std::string_view preprocessOnly      = COMP_PREPROCESS_ONLY;
+    static constexpr std::string_view sharedLibrary       = COMP_BUILD_SHARED_LIBRARY;
+    static constexpr std::string_view positionIndependent = COMP_POSITION_INDEPENDENT_CODE;
+    static constexpr std::string_view suppressOutput      = COMP_SUPPRESS_OUTPUT;
+    static constexpr std::string_view objectExtension     = ".o";
+
+    static constexpr std::string_view output      = "-o ";
+    static constexpr std::string_view includeDir  = "-I";
+    static constexpr std::string_view defineMacro = "-D";
+    static constexpr std::string_view libraryDir  = "-L";
+    static constexpr std::string_view linkLibrary = "-l";
+    static constexpr std::string_view cStandard   = "-std=c";
+    static constexpr std::string_view cppStandard = "-std=c++";
+
+    // -O<level>
+    static constexpr std::string_view optimization = "-O";
+    static constexpr std::array<std::string_view, 4> optimizationLevels = {};
+};
+
+template <>
+struct ToolchainTraits<Compiler::MSVC>
+{
+    static constexpr std::string_view compileOnly         = COMP_MSVC_COMPILE_ONLY;
+    static constexpr std::string_view preprocessOnly      = COMP_MSVC_PREPROCESS_ONLY;
+    static constexpr std::string_view sharedLibrary       = COMP_MSVC_BUILD_SHARED_LIBRARY;
+    static constexpr std::string_view positionIndependent = COMP_MSVC_POSITION_INDEPENDENT_CODE;
+    static constexpr std::string_view suppressOutput      = COMP_MSVC_SUPPRESS_OUTPUT;
+    static constexpr std::string_view objectExtension     = ".obj";
+
+    static constexpr std::string_view output      = "/Fo";
+    static constexpr std::string_view includeDir  = "/I";
+    static constexpr std::string_view defineMacro = "/D";
+    static constexpr std::string_view libraryDir  = "/LIBPATH:";
+    static constexpr std::string_view linkLibrary = "";
+    static constexpr std::string_view cStandard   = "";
+    static constexpr std::string_view cppStandard = "/std:c++";
+
+    // a fixed flag per level. (0-3, anything else adds nothing)
+    static constexpr std::string_view optimization = "";
+    static constexpr std::array<std::string_view, 4> optimizationLevels = {"/Od", "/O1", "/O2", "/Ox"};
+};
+
+// the traits of one toolchain as a table, picked once per target (GetToolchain) and used to append the flags to a
+// command without building temporaries.
+struct Toolchain
+{
+    std::string_view compileOnly, preprocessOnly, sharedLibrary, positionIndependent, suppressOutput,
+        objectExtension;
+    std::string_view output, includeDir, defineMacro, libraryDir, linkLibrary, cStandard, cppStandard;
+    std::string_view optimization;
+    std::array<std::string_view, 4> optimizationLevels;
+
+    template <typename Traits>
+    static constexpr Toolchain From()
+    {
+        return {Traits::compileOnly, Traits::preprocessOnly, Traits::sharedLibrary, Traits::positionIndependent,
+                Traits::suppressOutput, Traits::objectExtension, Traits::output, Traits::includeDir,
+                Traits::defineMacro, Traits::libraryDir, Traits::linkLibrary, Traits::cStandard, Traits::cppStandard,
+                Traits::optimization, Traits::optimizationLevels};
+    }
+
+    // <prefix><value><space>
+    static void Append(std::string &command, std::string_view prefix, std::string_view value)
+    {
+        command.append(prefix).append(value).push_back(' ');
+    }
+
+    void AppendStandard(std::string &command, FileType fileType, i32 standard) const
+    {
+        std::string_view prefix = (fileType == FileType::C) ? cStandard : cppStandard;
+        if(!prefix.empty())
+            Append(command, prefix, std::to_string(standard));
+    }
+
+    void AppendOptimization(std::string &command, i32 level) const
+    {
+        if(!optimization.empty())
+            Append(command, optimization, std::to_string(level));
+        else if(level >= 0 && level < (i32)optimizationLevels.size())
+            Append(command, optimizationLevels[level], "");
+    }
+};
+
+// adding a toolchain: specialize ToolchainTraits and return its table here.
+inline const Toolchain &GetToolchain(Compiler compiler)
+{
+    static constexpr Toolchain gnu  = Toolchain::From<ToolchainTraits<Compiler::GCC>>();
+    static constexpr Toolchain msvc = Toolchain::From<ToolchainTraits<Compiler::MSVC>>();
+
+    return (compiler == Compiler::MSVC) ? msvc : gnu;
+}
+
+} // namespace Y::Cache
@@ -31,16 +31,32 @@ CommandInfo ParseCLI(std::vector<std::string> arguments, std::vector<Command> co
         // ex: Proj1 --config-file ./YMake.toml -C
         if(args[i][0] == '-')
         {
+            // --option=value
+            std::string option = args[i];
+            std::string inlineValue;
+            bool hasInlineValue = false;
+            if(option.rfind("--", 0) == 0 && option.find('=') != std::string::npos)
+            {
+                inlineValue    = option.substr(option.find('=') + 1);
+                option         = option.substr(0, option.find('='));
+                hasInlineValue = true;
+            }
+
             // found an arg.
             bool found = false;
             for(CommandArgument &arg : calledCmd.args)
             {
                 // looking for it in the options for the command.
-                if(args[i] == arg.shortOpt || args[i] == arg.longOpt)
+                if(option == arg.shortOpt || option == arg.longOpt)
                 {
                     // found it!
                     found = true;
-                    if(arg.valType == ValueType::BOOL || arg.valType == ValueType::NONE)
+                    if(hasInlineValue)
+                    {
+                        foundAvailableArgs[arg.name] = inlineValue;
+                        usedArgs.push_back(args[i]);
+                    }
+                    else if(arg.valType == ValueType::BOOL || arg.valType == ValueType::NONE)
                     {
                         // no need to check the other args.
                         foundAvailableArgs[arg.name] = "NULL";
@@ -416,9 +432,115 @@ void BuildProjects(std::vector<std::string> &input, std::map<std::string, std::s
 
     bool cleanBuild = (args.count("clean build") > 0);
 
+    Build::BuildOptions options;
+    if(args.count("jobs") > 0)
+    {
+        if(args["jobs"] == "auto")
+        {
+            options.autoJobs = true;
+        }
+        else
+        {
+            i32 jobs = std::atoi(args["jobs"].c_str());
+            if(jobs <= 0)
+            {
+                LLOG(RED_TEXT("[YMAKE ERROR]: "), "invalid number of jobs: ", args["jobs"], "\n");
+                LLOG("\tex: --jobs 8, or --jobs=auto\n");
+                exit(1);
+            }
+            options.jobs = static_cast<usize>(jobs);
+        }
+    }
+
+    // failure policy.
+    if(args.count("fail fast") > 0 && args.count("keep going") > 0)
+    {
+        LLOG(RED_TEXT("[YMAKE ERROR]: "), "--fail-fast and --keep-going can't be used together.\n");
+        exit(1);
+    }
+
+    if(args.count("fail fast") > 0)
+        options.onFailure = Build::FailurePolicy::FAIL_FAST;
+
+    if(args.count("keep going") > 0)
+    {
+        options.onFailure = Build::FailurePolicy::KEEP_GOING;
+
+        // --keep-going=N: stop after N failures.
+        if(args["keep going"] != "NULL")
+        {
+            i32 maxFailures = std::atoi(args["keep going"].c_str());
+            if(maxFailures <= 0)
+            {
+                LLOG(RED_TEXT("[YMAKE ERROR]: "), "invalid number of failures: ", args["keep going"], "\n");
+                LLOG("\tex: --keep-going, or --keep-going=10\n");
+                exit(1);
+            }
+            options.maxFailures = static_cast<usize>(maxFailures);
+        }
+    }
+
+    // jobserver: shared with make (as a client) or exported to the compilers/linkers we run.
+    std::string jobserverStyle = (args.count("jobserver style") > 0) ? args["jobserver style"] : "pipe";
+    if(jobserverStyle == "pipe" || jobserverStyle == "fifo")
+    {
+        usize jobs = (options.jobs != 0) ? options.jobs : GetMaxThreads();
+        Build::InitJobServer(jobs, (jobserverStyle == "fifo") ? Build::JobServerStyle::FIFO
+                                                               : Build::JobServerStyle::PIPE);
+    }
+    else if(jobserverStyle != "none")
+    {
+        LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "jobserver style \'", jobserverStyle, "\' unsupported.\n");
+        LLOG("\tavailable styles: pipe, fifo, none\n");
+    }
+
     std::vector<Project> allProjects = Cache::SafeLoadProjectsFromCache(path.c_str());
 
+    if(args.count("memory budget") > 0)
+    {
+        u64 memoryBudget = 0;
+        try
+        {
+            memoryBudget = Parse::ToMegabytes(args["memory budget"]);
+        }
+        catch(...)
+        {
+            LLOG(RED_TEXT("[YMAKE ERROR]: "), "invalid memory budget: ", args["memory budget"], "\n");
+            LLOG("\tex: --memory-budget 16G\n");
+            exit(1);
+        }
+
+        for(Project &proj : allProjects)
+            proj.memoryBudget = memoryBudget;
+    }
+
+    // --unity, --unity=off (overrides build.unity)
+    if(args.count("unity") > 0)
+    {
+        std::string value = args["unity"];
+        bool unity        = !(value == "off" || value == "false" || value == "0");
+
+        for(Project &proj : allProjects)
+            proj.unity = unity;
+    }
+
+    // --pgo=generate, --pgo=use
+    if(args.count("pgo") > 0)
+    {
+        std::string pgo = args["pgo"];
+        if(pgo != YMAKE_PGO_GENERATE && pgo != YMAKE_PGO_USE)
+        {
+            LLOG(RED_TEXT("[YMAKE ERROR]: "), "invalid pgo mode: ", pgo, "\n");
+            LLOG("\tex: --pgo=generate, or --pgo=use\n");
+            exit(1);
+        }
+
+        for(Project &proj : allProjects)
+            proj.pgo = pgo;
+    }
+
     std::vector<Project> projectsToBuild;
+    std::vector<std::string> failedProjects; // (--keep-going)
 
     for(std::string &projName : input)
     {
@@ -455,12 +577,15 @@ void BuildProjects(std::vector<std::string> &input, std::map<std::string, std::s
         {
             try
             {
-                Build::BuildProject(proj, mode, cleanBuild);
+                Build::BuildProject(proj, mode, cleanBuild, options);
             }
             catch(Y::Error &err)
             {
                 LLOG(RED_TEXT("[YMAKE ERROR]: "), "couldn't build project:", proj.name, "\n\t", err.what(), "\n");
-                exit(1);
+                if(options.onFailure != Build::FailurePolicy::KEEP_GOING || Build::AreProcessesCancelled())
+                    exit(1);
+
+                failedProjects.push_back(proj.name);
             }
         }
     }
@@ -478,19 +603,82 @@ void BuildProjects(std::vector<std::string> &input, std::map<std::string, std::s
         {
             try
             {
-                Build::BuildProject(proj, mode, cleanBuild);
+                Build::BuildProject(proj, mode, cleanBuild, options);
             }
             catch(Y::Error &err)
             {
                 LLOG(RED_TEXT("[YMAKE ERROR]: "), "couldn't build project:", proj.name, "\n\t", err.what(), "\n");
-                exit(1);
+                if(options.onFailure != Build::FailurePolicy::KEEP_GOING || Build::AreProcessesCancelled())
+                    exit(1);
+
+                failedProjects.push_back(proj.name);
             }
         }
     }
 
+    if(!failedProjects.empty())
+    {
+        LLOG(RED_TEXT("[YMAKE BUILD FAILED]: "), failedProjects.size(), " project(s) failed to build:\n");
+        for(const auto &projName : failedProjects)
+            LLOG("\t", CYAN_TEXT(projName), "\n");
+        exit(1);
+    }
+
     return;
 }
 
+// ymake pgo merge <projects>
+void MergeProfiles(std::vector<std::string> &input, std::map<std::string, std::string> &args)
+{
+    if(input.empty() || input[0] != "merge")
+    {
+        LLOG(RED_TEXT("[YMAKE ERROR]: "), "unknown pgo command.\n");
+        LLOG("\tex: ymake pgo merge <projects>\n");
+        throw Y::Error("unknown pgo command.");
+    }
+
+    std::string path = (args.count("config") > 0) ? args["config"] : YMAKE_DEFAULT_FILE;
+    std::vector<Project> allProjects = Cache::SafeLoadProjectsFromCache(path.c_str());
+
+    std::vector<Project> projectsToMerge;
+    for(usize i = 1; i < input.size(); i++)
+    {
+        auto proj = std::find_if(allProjects.begin(), allProjects.end(),
+                                 [&](const Project &project) { return project.name == input[i]; });
+        if(proj == allProjects.end())
+        {
+            LLOG(YELLOW_TEXT("[YMAKE WARN]: "), "ignoring unspecified project: ", input[i], "\n");
+            continue;
+        }
+
+        projectsToMerge.push_back(*proj);
+    }
+
+    if(input.size() == 1)
+        projectsToMerge = allProjects;
+
+    bool failed = false;
+    for(const Project &proj : projectsToMerge)
+    {
+        LLOG(BLUE_TEXT("[YMAKE PGO]: "), "merging the profiles of project: ", CYAN_TEXT(proj.name), "...\n");
+
+        Cache::Compiler compiler = Cache::WhatCompiler(proj.cppCompiler.empty() ? proj.cCompiler : proj.cppCompiler);
+        try
+        {
+            Build::MergeProfiles(Build::GetPGODir(proj.name), compiler);
+        }
+        catch(Y::Error &err)
+        {
+            LLOG(RED_TEXT("[YMAKE ERROR]: "), "couldn't merge the profiles of project: ", proj.name, "\n\t",
+                 err.what(), "\n");
+            failed = true;
+        }
+    }
+
+    if(failed)
+        exit(1);
+}
+
 void CleanAllCache(std::vector<std::string> &input, std::map<std::string, std::string> &args)
 {
 
@@ -131,6 +131,7 @@ void OutputProjectsInfo(std::vector<std::string> &input, std::map<std::string, s
 void SetupProjectInfo(std::vector<std::string> &input, std::map<std::string, std::string> &args);
 
 void BuildProjects(std::vector<std::string> &input, std::map<std::string, std::string> &args);
+void MergeProfiles(std::vector<std::string> &input, std::map<std::string, std::string> &args);
 
 void CleanAllCache(std::vector<std::string> &input, std::map<std::string, std::string> &args);
 
@@ -40,6 +40,24 @@
 #define YMAKE_TOML_LIB_PATH        "path"
 #define YMAKE_TOML_LIB_INCLUDE     "include"
 #define YMAKE_TOML_LIB_TYPE        "type"
+#define YMAKE_TOML_MEMORY          "memory"
+#define YMAKE_TOML_UNITY           "unity"
+#define YMAKE_TOML_UNITY_EXCLUDE   "unity_exclude"
+#define YMAKE_TOML_PCH             "pch"
+#define YMAKE_TOML_LINKER          "linker"
+#define YMAKE_TOML_LTO             "lto"
+#define YMAKE_TOML_POST_LINK       "post_link"
+#define YMAKE_TOML_TRAIN           "train"
+#define YMAKE_TOML_SPLIT_DWARF     "split_dwarf"
+#define YMAKE_TOML_DWP             "dwp"
+#define YMAKE_TOML_COMPRESS        "compress"
+#define YMAKE_TOML_STRIP           "strip"
+#define YMAKE_TOML_THIN_ARCHIVE    "thin_archive"
+#define YMAKE_TOML_PRELINK         "prelink"
+#define YMAKE_TOML_VISIBILITY      "visibility"
+#define YMAKE_TOML_EXPORTS         "exports"
+#define YMAKE_TOML_VERSION_SCRIPT  "version_script"
+#define YMAKE_TOML_LINK_PRESET     "link_preset"
 
 #define YMAKE_CONFIG_METADATA_CACHE_FILENAME "config.cache"
 #define YMAKE_TIMESTAMP_CACHE_FILENAME       "timestamp.cache"
@@ -47,10 +65,111 @@
 #define YMAKE_CONFIG_PATH_CACHE_FILENAME     "path.cache"
 #define YMAKE_METADATA_CACHE_FILENAME        "metadata.cache"
 #define YMAKE_PREPROCESS_CACHE_FILENAME      "preprocessed_metadata.cache"
+#define YMAKE_COMPILE_STATS_CACHE_FILENAME   "compile_stats.cache"
+#define YMAKE_UNITY_CACHE_FILENAME           "unity.cache"
+#define YMAKE_UNITY_DIR                      "unity"
+#define YMAKE_PCH_DIR                        "pch"
+#define YMAKE_PCH_HEADER_FILENAME            "ymake_pch.h"
+#define YMAKE_PCH_AUTO_CACHE_FILENAME        "pch_auto.cache"
+#define YMAKE_MODULES_DIR                    "modules"
+#define YMAKE_MODULE_MAPPER_FILENAME         "module.map"
+#define YMAKE_LINKERS_CACHE_FILENAME         "linkers.cache"
+#define YMAKE_LINK_STATS_CACHE_FILENAME      "link_stats.cache"
+#define YMAKE_LTO_DIR                        "lto"
+#define YMAKE_PGO_DIR                        "pgo"
+#define YMAKE_PGO_CACHE_FILENAME             "pgo.cache"
+#define YMAKE_PGO_PROFDATA_FILENAME          "ymake.profdata"
+#define YMAKE_POST_LINK_DIR                  "postlink"
+#define YMAKE_POST_LINK_CACHE_FILENAME       "postlink.cache"
+#define YMAKE_SYMBOL_ORDER_FILENAME          "symbols.order"
+#define YMAKE_SECTION_ORDER_FILENAME         "sections.order"
+#define YMAKE_RESPONSE_FILES_DIR             "rsp"
+#define YMAKE_ARCHIVE_CACHE_FILENAME         "archive.cache"
+#define YMAKE_PRELINK_CACHE_FILENAME         "prelink.cache"
+#define YMAKE_EXPORTS_MAP_FILENAME           "exports.map"
+#define YMAKE_TOOLCHAIN_CACHE_FILENAME       "toolchain.cache"
+#define YMAKE_COMMANDS_CACHE_FILENAME        "commands.cache"
 
 // 24 hrs
 #define YMAKE_TIMESTAMP_THRESHHOLD_SEC 86400
 
+// reproducible builds. (the latest timestamp gcc takes: 9999-12-31 23:59:59)
+#define YMAKE_SOURCE_DATE_EPOCH_ENV "SOURCE_DATE_EPOCH"
+#define YMAKE_SOURCE_DATE_EPOCH_MAX 253402300799ULL
+
+// memory admission control.
+// predicted peak RSS for a translation unit with no compile history (conservative).
+#define YMAKE_DEFAULT_TU_PEAK_RSS_MB 1024
+// % of physical memory used as the budget when build.memory is not set.
+#define YMAKE_DEFAULT_MEMORY_BUDGET_PERCENT 75
+// rounds of retries (each with less parallelism, the last one runs jobs alone) for OOM-killed compiles.
+#define YMAKE_OOM_RETRY_ROUNDS 3
+// what the compiler drivers print when the OOM killer picks the compiler proper. (cc1plus, clang -cc1)
+#define YMAKE_GCC_KILLED_DIAGNOSTIC   "Killed signal terminated program"
+#define YMAKE_CLANG_KILLED_DIAGNOSTIC "unable to execute command: Killed"
+
+// --jobs=auto tuning.
+#define YMAKE_JOBS_AUTO_INTERVAL_MS 1000
+// PSI "some avg10" thresholds (% of time stalled) above which the job count is lowered.
+#define YMAKE_JOBS_AUTO_CPU_PRESSURE_HIGH 60.0
+#define YMAKE_JOBS_AUTO_MEM_PRESSURE_HIGH 10.0
+#define YMAKE_JOBS_AUTO_IO_PRESSURE_HIGH  40.0
+// below these, the job count may be raised again.
+#define YMAKE_JOBS_AUTO_CPU_PRESSURE_LOW 20.0
+#define YMAKE_JOBS_AUTO_MEM_PRESSURE_LOW 1.0
+
+// unity builds.
+// max number of source files in a generated unity translation unit.
+#define YMAKE_UNITY_MAX_BATCH_SIZE 16
+// predicted compile time (seconds) of a file with no compile history (when no file has history).
+#define YMAKE_UNITY_DEFAULT_FILE_SECONDS 1.0
+
+// precompiled headers.
+// pch = "auto" -> headers are picked from the #includes of the source files.
+#define YMAKE_PCH_AUTO "auto"
+// min % of the source files that include a header for it to be precompiled.
+#define YMAKE_PCH_AUTO_MIN_USAGE_PERCENT 50
+// project headers changed in the last N hours aren't precompiled. (they'd invalidate the pch too often)
+#define YMAKE_PCH_AUTO_STABLE_HOURS 24
+#define YMAKE_PCH_AUTO_MAX_HEADERS  32
+
+// c++20 modules. (used when cpp.std >= 20 and a source file declares or imports a module)
+#define YMAKE_MODULES_MIN_CPP_STD 20
+
+// build.linker = "auto" -> the fastest linker available. (mold, lld, gold)
+#define YMAKE_LINKER_AUTO "auto"
+// -fuse-ld=x runs ld.x
+#define YMAKE_LINKER_BINARY_PREFIX "ld."
+
+// compiler.release.lto = "thin" | "full" | "off"
+#define YMAKE_LTO_THIN "thin"
+#define YMAKE_LTO_FULL "full"
+#define YMAKE_LTO_OFF  "off"
+
+// ymake build --pgo=generate | use
+#define YMAKE_PGO_GENERATE "generate"
+#define YMAKE_PGO_USE      "use"
+
+// compiler.release.post_link = "bolt" | "order" | "off", after linking a release executable.
+// compiler.release.train is the training command, "{bin}" is replaced by the program. (prepended if missing)
+#define YMAKE_POST_LINK_BOLT  "bolt"
+#define YMAKE_POST_LINK_ORDER "order"
+#define YMAKE_POST_LINK_OFF   "off"
+#define YMAKE_TRAIN_BINARY    "{bin}"
+
+// libs.src: prelink = true | "gc" -> the objects of a static library are pre-linked in one relocatable object.
+// "gc" also drops the sections no exported symbol refers to.
+#define YMAKE_PRELINK_ON "on"
+#define YMAKE_PRELINK_GC "gc"
+
+// build.visibility / libs.src: visibility = "hidden" | "default"
+#define YMAKE_VISIBILITY_HIDDEN  "hidden"
+#define YMAKE_VISIBILITY_DEFAULT "default"
+
+// compiler.debug.compress = "zstd" | "zlib" (true -> zstd)
+#define YMAKE_DEBUG_COMPRESS_ZSTD "zstd"
+#define YMAKE_DEBUG_COMPRESS_ZLIB "zlib"
+
 // compiler specific flags
 // gcc, icc, clang => COMP_{FLAG}
 // msvc => COMP_MSVC_{FLAG}
@@ -63,6 +182,7 @@
 
 #define COMP_INCLUDE_DIR(x)      std::string("-I") + x + " "
 #define COMP_MSVC_INCLUDE_DIR(x) std::string("/I") + x + " "
+#define COMP_QUOTE_INCLUDE_DIR(x) std::string("-iquote ") + x + " "
 
 #define COMP_LIBRARY_DIR(x)      std::string("-L") + x + " "
 #define COMP_MSVC_LIBRARY_DIR(x) std::string("/LIBPATH:") + x + " "
@@ -70,6 +190,91 @@
 #define COMP_LINK_LIBRARY(x)      std::string("-l") + x + " "
 #define COMP_MSVC_LINK_LIBRARY(x) std::string("") + x + " "
 
+#define COMP_INCLUDE_FILE(x)       std::string("-include ") + x + " -Winvalid-pch "
+#define COMP_CLANG_INCLUDE_PCH(x)  std::string("-include-pch ") + x + " "
+#define COMP_LANG_C_HEADER         "-x c-header "
+#define COMP_LANG_CPP_HEADER       "-x c++-header "
+#define COMP_DEPFILE(x)            std::string("-MD -MF ") + x + " "
+#define COMP_LANG_CPP              "-x c++ "
+
+#define COMP_USE_LINKER(x)          std::string("-fuse-ld=") + x + " "
+#define COMP_LINKER_VERSION         "-Wl,--version "
+#define COMP_TOOL_VERSION           "--version "
+#define COMP_DUMP_MACHINE           "-dumpmachine "
+#define COMP_MOLD_THREADS(x)        std::string("-Wl,--thread-count=") + std::to_string(x) + " "
+#define COMP_LLD_THREADS(x)         std::string("-Wl,--threads=") + std::to_string(x) + " "
+#define COMP_GOLD_THREADS(x)        std::string("-Wl,--threads -Wl,--thread-count=") + std::to_string(x) + " "
+
+#define COMP_GCC_LTO_JOBS(x)              std::string("-flto=") + std::to_string(x) + " "
+#define COMP_GCC_LTO_ONE_PARTITION        "-flto-partition=one "
+#define COMP_CLANG_THIN_LTO               "-flto=thin "
+#define COMP_CLANG_FULL_LTO               "-flto=full "
+#define COMP_CLANG_LTO_JOBS(x)            std::string("-flto-jobs=") + std::to_string(x) + " "
+#define COMP_LLD_THINLTO_CACHE_DIR(x)     std::string("-Wl,--thinlto-cache-dir=") + x + " "
+#define COMP_LD64_THINLTO_CACHE_DIR(x)    std::string("-Wl,-cache_path_lto,") + x + " "
+#define COMP_LLVM_PLUGIN_LTO_CACHE_DIR(x) std::string("-Wl,-plugin-opt,cache-dir=") + x + " "
+
+#define COMP_GCC_PROFILE_GENERATE(x)         std::string("-fprofile-generate=") + x + " "
+#define COMP_GCC_PROFILE_USE(x)              std::string("-fprofile-use=") + x + " "
+#define COMP_GCC_NO_MISSING_PROFILE          "-Wno-missing-profile "
+#define COMP_CLANG_PROFILE_INSTR_GENERATE(x) std::string("-fprofile-instr-generate=") + x + " "
+#define COMP_CLANG_PROFILE_INSTR_USE(x)      std::string("-fprofile-instr-use=") + x + " "
+#define COMP_LLVM_PROFDATA_MERGE(x)          std::string("llvm-profdata merge -output=") + x + " "
+
+#define COMP_VISIBILITY_HIDDEN         "-fvisibility=hidden "
+#define COMP_VISIBILITY_INLINES_HIDDEN "-fvisibility-inlines-hidden "
+#define COMP_VERSION_SCRIPT(x)         std::string("-Wl,--version-script=") + x + " "
+#define COMP_DATA_SECTIONS             "-fdata-sections "
+#define COMP_RELEASE_LINK_PRESET       "-Wl,--gc-sections,--as-needed,-O1 "
+#define COMP_GNU_HASH_STYLE            "-Wl,--hash-style=gnu "
+
+#define COMP_FILE_PREFIX_MAP(from, to)  std::string("-ffile-prefix-map=") + from + "=" + to + " "
+#define COMP_DEBUG_PREFIX_MAP(from, to) std::string("-fdebug-prefix-map=") + from + "=" + to + " "
+
+#define COMP_RELOCATABLE  "-r -nostdlib "
+#define COMP_PRELINK_GC   "-Wl,--gc-sections -Wl,--gc-keep-exported "
+
+#define COMP_EMIT_RELOCS                   "-Wl,--emit-relocs "
+#define COMP_FUNCTION_SECTIONS             "-ffunction-sections "
+#define COMP_SYMBOL_ORDERING_FILE(x)       std::string("-Wl,--symbol-ordering-file=") + x + " "
+#define COMP_GOLD_SECTION_ORDERING_FILE(x) std::string("-Wl,--section-ordering-file=") + x + " "
+
+#define BOLT_INSTRUMENT(bin, fdata, out)                                                                               \
+    std::string("llvm-bolt ") + bin + " -instrument -instrumentation-file=" + fdata + " -o " + out + " "
+#define BOLT_OPTIMIZE(bin, fdata, out)                                                                                 \
+    std::string("llvm-bolt ") + bin + " -data=" + fdata + " -o " + out +                                               \
+        " -reorder-blocks=ext-tsp -reorder-functions=hfsort -split-functions -split-all-cold -split-eh -dyno-stats "
+
+#define COMP_SPLIT_DWARF           "-gsplit-dwarf "
+#define COMP_DWARF_4               "-gdwarf-4 "
+#define COMP_COMPRESS_DEBUG(x)     std::string("-gz=") + x + " "
+#define DWP_PACKAGE(dwp, exe, out) std::string(dwp) + " -e " + exe + " -o " + out + " "
+#define OBJCOPY_KEEP_DEBUG(x, y)   std::string("objcopy --only-keep-debug ") + x + " " + y + " "
+#define OBJCOPY_DEBUGLINK(x, y)    std::string("objcopy --add-gnu-debuglink=") + x + " " + y + " "
+#define STRIP_UNNEEDED(x)          std::string("strip --strip-unneeded ") + x + " "
+
+// 'T': thin archive. (the members are references to the objects)
+// 'D': deterministic. (zero timestamps, uids and gids, the archive only depends on its members)
+#define AR_CREATE(ar, thin, out)  std::string(ar) + ((thin) ? " rcsTD " : " rcsD ") + out + " "
+#define AR_REPLACE(ar, thin, out) std::string(ar) + ((thin) ? " rTD " : " rD ") + out + " "
+#define AR_DELETE(ar, out)        std::string(ar) + " dD " + out + " "
+#define AR_INDEX(ar, out)         std::string(ar) + " sD " + out + " "
+
+#define PERF_RECORD(out) std::string("perf record -q -o ") + out + " -- "
+#define PERF_REPORT_SYMBOLS(in)                                                                                        \
+    std::string("perf report -i ") + in + " --stdio --no-children --no-demangle --sort symbol "
+
+#define COMP_GCC_MODULES                   "-fmodules-ts "
+#define COMP_GCC_MODULE_MAPPER(x)          std::string("-fmodule-mapper=") + x + " "
+#define COMP_GCC_SYSTEM_HEADER_UNIT        "-x c++-system-header "
+#define COMP_GCC_P1689(file, target)                                                                                   \
+    std::string("-fdeps-format=p1689r5 -fdeps-file=") + file + " -fdeps-target=" + target + " "
+#define COMP_CLANG_MODULE_OUTPUT(x)        std::string("-fmodule-output=") + x + " "
+#define COMP_CLANG_PREBUILT_MODULE_PATH(x) std::string("-fprebuilt-module-path=") + x + " "
+#define COMP_CLANG_MODULE_FILE(x)          std::string("-fmodule-file=") + x + " "
+#define COMP_CLANG_SYSTEM_HEADER_UNIT      "-xc++-system-header --precompile "
+#define COMP_CLANG_USER_HEADER_UNIT        "-xc++-user-header --precompile "
+
 #define COMP_PREPROCESS_ONLY      "-E "
 #define COMP_MSVC_PREPROCESS_ONLY "/P "
 
@@ -201,13 +406,24 @@ static_assert(sizeof(usize) == sizeof(void *), "usize size mismatch.");
 #endif
 
 #ifndef IPLATFORM_WINDOWS
+    #define YMAKE_NULL_DEVICE    "/dev/null"
     #define COMP_SUPPRESS_OUTPUT " > /dev/null 2>&1"
 #else
+    #define YMAKE_NULL_DEVICE    "NUL"
     #define COMP_SUPPRESS_OUTPUT " > NUL 2>&1"
 #endif
 
 #define COMP_MSVC_SUPPRESS_OUTPUT " /nologo > NUL 2>&1"
 
+// file lists longer than this (in bytes) are passed in a response file. (cmd.exe stops at 8191 characters)
+#ifndef IPLATFORM_WINDOWS
+    #define YMAKE_RESPONSE_FILE_THRESHOLD 32768
+#else
+    #define YMAKE_RESPONSE_FILE_THRESHOLD 4096
+#endif
+
+#define COMP_RESPONSE_FILE(x) std::string("@") + x + " "
+
 // platform specific -> extensions
 
 // dynamic library extension
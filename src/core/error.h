@@ -4,13 +4,20 @@
 
 namespace Y {
 
-#define YERR_FILE_COULDNT_OPEN 32
+#define YERR_FILE_COULDNT_OPEN  32
+#define YERR_PROCESS_OOM_KILLED 33
+#define YERR_COMPILE_FAILED     34
+#define YERR_BUILD_CANCELLED    35
+#define YERR_BUILD_FAILED       36
+#define YERR_MODULE_GRAPH       37
+#define YERR_PGO_PROFILE        38
+#define YERR_LINK_FAILED        39
 
 class Error
 {
     private:
-    i32 errnum;
-    const char *errtxt;
+    i32 errnum         = 0;
+    const char *errtxt = "";
 
     public:
     Error() {}
@@ -38,8 +38,19 @@ int main(int argc, char **argv)
             Y::CommandArgument("config", "/path/to/YMake.toml", "-c", "--config-file"),
             Y::CommandArgument("build mode", "build the project in [release or debug] mode", "-b", "--build-mode"),
             Y::CommandArgument("clean build", "rebuild the project entirely (including libraries)", "-C", "--clean", Y::ValueType::BOOL),
+            Y::CommandArgument("jobs", "max number of parallel compile jobs, or \'auto\' to adapt to the system load (--jobs=auto)", "-j", "--jobs"),
+            Y::CommandArgument("jobserver style", "make jobserver exported to compilers/linkers [pipe, fifo, none] (default: pipe)", "-J", "--jobserver-style"),
+            Y::CommandArgument("memory budget", "max memory for parallel compiles, ex: 16G, 8192M (overrides build.memory)", "-m", "--memory-budget"),
+            Y::CommandArgument("unity", "unity (jumbo) build: compile sources in batches (--unity=off to disable) (overrides build.unity)", "-u", "--unity", Y::ValueType::BOOL),
+            Y::CommandArgument("fail fast", "on the first error, cancel queued jobs and terminate running compilers", "-F", "--fail-fast", Y::ValueType::BOOL),
+            Y::CommandArgument("keep going", "build everything not depending on a failure, report all errors at the end (--keep-going=N stops after N)", "-k", "--keep-going", Y::ValueType::BOOL),
+            Y::CommandArgument("pgo", "profile guided optimization [generate, use] (--pgo=generate: instrumented build, --pgo=use: after 'ymake pgo merge')", "-P", "--pgo"),
         }, Y::BuildProjects),
 
+        Y::Command("pgo", "merge <projects> [args...]\tmerge the profiles written by the --pgo=generate build(s) for --pgo=use [if no project(s) are specified, merges all projects]", {
+            Y::CommandArgument("config", "/path/to/YMake.toml", "-c", "--config-file"),
+        }, Y::MergeProfiles),
+
         Y::Command("clean", "[args...]\tclean all the YMake-generated cache", {
             Y::CommandArgument("config", "/path/to/YMake.toml", "-c", "--config-file"),
         }, Y::CleanAllCache),
@@ -1,5 +1,7 @@
 #include "parser.h"
 
+#include <algorithm>
+#include <cctype>
 #include <filesystem>
 namespace fs = std::filesystem;
 
@@ -179,6 +181,35 @@ std::string ToLower(const std::string &str)
     return lower_str;
 }
 
+// "4096", "4096M", "4G" -> 4096 (MB)
+u64 ToMegabytes(const std::string &string)
+{
+    std::string str = ToLower(string);
+    if(str.empty())
+        throw Y::Error("specified an empty memory size.");
+
+    // (stoull takes "-1" as a huge number)
+    if(!std::isdigit(static_cast<unsigned char>(str.front())))
+        throw Y::Error("specified a negative (or invalid) memory size.");
+
+    usize end = 0;
+    u64 value = std::stoull(str, &end);
+
+    std::string unit = str.substr(end);
+    if(unit == "g" || unit == "gb")
+        value *= 1024;
+    else if(unit == "k" || unit == "kb")
+        value /= 1024;
+    else if(unit != "" && unit != "m" && unit != "mb")
+        throw Y::Error("specified an unknown memory unit. (use K, M or G)");
+
+    // (0 would be read as no budget at all)
+    if(value == 0)
+        throw Y::Error("specified a memory size under 1 MB.");
+
+    return value;
+}
+
 Lang ToLang(const std::string &string)
 {
     std::string str = ToLower(string);
@@ -190,6 +221,18 @@ Lang ToLang(const std::string &string)
     throw Y::Error("specified an unknown (or unsupported) language.");
 }
 
+// "hidden" or "default". (anything else warns, and is the default)
+std::string ToVisibility(const std::string &visibility, const std::string &target)
+{
+    if(visibility == YMAKE_VISIBILITY_HIDDEN)
+        return visibility;
+
+    if(visibility != YMAKE_VISIBILITY_DEFAULT)
+        LLOG(YELLOW_TEXT("[YMAKE TOML WARN]: "), "unknown visibility for '", target, "': ", visibility,
+             " (expected hidden or default). using the default.\n");
+    return "";
+}
+
 void ParseProjectData(const toml::table &config, Project &proj)
 {
     if(!config.contains(proj.name.c_str()))
@@ -332,6 +375,43 @@ void ParseProjectData(const toml::table &config, Project &proj)
         proj.buildDir = "./build";
     }
 
+    // memory budget for parallel compiles. (optional)
+    if(auto memory = mainTable[YMAKE_TOML_BUILD][YMAKE_TOML_MEMORY].value<i64>())
+    {
+        if(memory.value() > 0)
+        {
+            proj.memoryBudget = static_cast<u64>(memory.value());
+        }
+        else
+        {
+            LLOG(YELLOW_TEXT("[YMAKE TOML WARN]: "), "the memory budget (build.memory) for project '", proj.name,
+                 "' must be positive: ", memory.value(), "\n");
+            LLOG(PURPLE_TEXT("\tusing ", YMAKE_DEFAULT_MEMORY_BUDGET_PERCENT, "% of physical memory by default.\n"));
+            proj.memoryBudget = 0;
+        }
+    }
+    else if(auto memoryStr = mainTable[YMAKE_TOML_BUILD][YMAKE_TOML_MEMORY].value<std::string>())
+    {
+        try
+        {
+            proj.memoryBudget = ToMegabytes(memoryStr.value());
+        }
+        catch(std::exception &err)
+        {
+            LLOG(YELLOW_TEXT("[YMAKE TOML WARN]: "), "couldn't parse the memory budget (build.memory) for project '",
+                 proj.name, "': ", memoryStr.value(), "\n");
+            LLOG(PURPLE_TEXT("\tusing ", YMAKE_DEFAULT_MEMORY_BUDGET_PERCENT, "% of physical memory by default.\n"));
+            proj.memoryBudget = 0;
+        }
+        catch(Y::Error &err)
+        {
+            LLOG(YELLOW_TEXT("[YMAKE TOML WARN]: "), "couldn't parse the memory budget (build.memory) for project '",
+                 proj.name, "': ", err.what(), "\n");
+            LLOG(PURPLE_TEXT("\tusing ", YMAKE_DEFAULT_MEMORY_BUDGET_PERCENT, "% of physical memory by default.\n"));
+            proj.memoryBudget = 0;
+        }
+    }
+
     // src
     if(auto src = mainTable[YMAKE_TOML_SRC].value<std::string>())
     {
@@ -360,6 +440,43 @@ void ParseProjectData(const toml::table &config, Project &proj)
         proj.includeDirs.push_back(ExpandMacros(proj.src, dotenv));
     }
 
+    // precompiled header. (optional)
+    if(auto pch = mainTable[YMAKE_TOML_PCH].value<std::string>())
+        proj.pch = (pch.value() == YMAKE_PCH_AUTO) ? pch.value() : ExpandMacros(pch.value(), dotenv);
+
+    // unity build. (optional)
+    if(auto unity = mainTable[YMAKE_TOML_BUILD][YMAKE_TOML_UNITY].value<bool>())
+        proj.unity = unity.value();
+
+    if(auto unityExclude = mainTable[YMAKE_TOML_BUILD][YMAKE_TOML_UNITY_EXCLUDE].as_array())
+    {
+        for(const auto &file : *unityExclude)
+        {
+            if(auto path = file.value<std::string>())
+                proj.unityExclude.push_back(ExpandMacros(path.value(), dotenv));
+        }
+    }
+
+    // linker. (optional)
+    if(auto linker = mainTable[YMAKE_TOML_BUILD][YMAKE_TOML_LINKER].value<std::string>())
+    {
+        if(linker.value() == YMAKE_LINKER_AUTO || linker.value() == "mold" || linker.value() == "lld" ||
+           linker.value() == "gold" || linker.value() == "bfd")
+        {
+            proj.linker = linker.value();
+        }
+        else
+        {
+            LLOG(YELLOW_TEXT("[YMAKE TOML WARN]: "), "unknown linker (build.linker) for project '", proj.name, "': ",
+                 linker.value(), "\n");
+            LLOG(PURPLE_TEXT("\tusing the compiler's default linker. (expected auto, mold, lld, gold or bfd)\n"));
+        }
+    }
+
+    // symbol visibility. (optional)
+    if(auto visibility = mainTable[YMAKE_TOML_BUILD][YMAKE_TOML_VISIBILITY].value<std::string>())
+        proj.visibility = ToVisibility(visibility.value(), proj.name);
+
     // libs.src
     if(auto libsSrc = mainTable[YMAKE_TOML_LIBS][YMAKE_TOML_SRC].as_array())
     {
@@ -404,6 +521,27 @@ void ParseProjectData(const toml::table &config, Project &proj)
             {
                 library.type = ToBuildType(libType.value());
             }
+            else if(auto libTypes = lib[YMAKE_TOML_LIB_TYPE].as_array())
+            {
+                // type = ["static", "shared"]: compiled once, packaged as both. (the project links with the first)
+                std::vector<BuildType> types;
+                for(const auto &type : *libTypes)
+                {
+                    if(auto typeName = type.value<std::string>())
+                        types.push_back(ToBuildType(typeName.value()));
+                }
+
+                if(types.empty() || types.size() > 2 ||
+                   std::find(types.begin(), types.end(), BuildType::EXECUTABLE) != types.end())
+                {
+                    LLOG(RED_TEXT("[YMAKE TOML ERROR]: "), "library: ", library.name, " for project: ", proj.name,
+                         " can only be \"static\", \"shared\" or both.\n");
+                    throw Y::Error("specified an unknown build type");
+                }
+
+                library.type = types[0];
+                library.dual = (types.size() == 2 && types[0] != types[1]);
+            }
             else
             {
                 LLOG(YELLOW_TEXT("[YMAKE TOML WARN]: "), "didn't specify the build type for library: ", library.name,
@@ -412,6 +550,40 @@ void ParseProjectData(const toml::table &config, Project &proj)
                 library.type = BuildType::STATIC_LIB;
             }
 
+            if(auto libPch = lib[YMAKE_TOML_PCH].value<std::string>())
+                library.pch = (libPch.value() == YMAKE_PCH_AUTO) ? libPch.value() : ExpandMacros(libPch.value(), dotenv);
+
+            if(auto libThinArchive = lib[YMAKE_TOML_THIN_ARCHIVE].value<bool>())
+                library.thinArchive = libThinArchive.value();
+
+            // prelink = true | "gc"
+            if(auto libPrelink = lib[YMAKE_TOML_PRELINK].value<bool>())
+                library.prelink = libPrelink.value() ? YMAKE_PRELINK_ON : "";
+            else if(auto libPrelinkMode = lib[YMAKE_TOML_PRELINK].value<std::string>())
+            {
+                if(libPrelinkMode.value() == YMAKE_PRELINK_GC)
+                    library.prelink = YMAKE_PRELINK_GC;
+                else
+                    LLOG(YELLOW_TEXT("[YMAKE TOML WARN]: "), "unknown prelink: ", libPrelinkMode.value(),
+                         " for library: ", library.name, " (expected true, false or \"gc\"). ignoring it.\n");
+            }
+
+            if(auto libVisibility = lib[YMAKE_TOML_VISIBILITY].value<std::string>())
+                library.visibility = ToVisibility(libVisibility.value(), library.name);
+
+            // the dynamic symbols of a shared library. (names, or a version script)
+            if(auto libExports = lib[YMAKE_TOML_EXPORTS].as_array())
+            {
+                for(const auto &name : *libExports)
+                {
+                    if(auto exportName = name.value<std::string>())
+                        library.exports.push_back(exportName.value());
+                }
+            }
+
+            if(auto libVersionScript = lib[YMAKE_TOML_VERSION_SCRIPT].value<std::string>())
+                library.versionScript = ExpandMacros(libVersionScript.value(), dotenv);
+
             proj.libs.push_back(library);
         }
     }
@@ -462,6 +634,82 @@ void ParseProjectData(const toml::table &config, Project &proj)
         proj.optimizationRelease = 3;
     }
 
+    // release lto. (optional)
+    if(auto lto = mainTable[YMAKE_TOML_COMPILER][YMAKE_TOML_RELEASE][YMAKE_TOML_LTO].value<std::string>())
+    {
+        if(lto.value() == YMAKE_LTO_THIN || lto.value() == YMAKE_LTO_FULL)
+        {
+            proj.lto = lto.value();
+        }
+        else if(lto.value() != YMAKE_LTO_OFF)
+        {
+            LLOG(YELLOW_TEXT("[YMAKE TOML WARN]: "), "unknown lto mode (release.lto) for project '", proj.name, "': ",
+                 lto.value(), "\n");
+            LLOG(PURPLE_TEXT("\tlto is off. (expected thin, full or off)\n"));
+        }
+    }
+
+    // split dwarf, compressed debug info. (optional, debug)
+    if(auto splitDwarf = mainTable[YMAKE_TOML_COMPILER][YMAKE_TOML_DEBUG][YMAKE_TOML_SPLIT_DWARF].value<bool>())
+        proj.splitDwarf = splitDwarf.value();
+
+    if(auto dwp = mainTable[YMAKE_TOML_COMPILER][YMAKE_TOML_DEBUG][YMAKE_TOML_DWP].value<bool>())
+        proj.dwp = dwp.value();
+
+    auto compress = mainTable[YMAKE_TOML_COMPILER][YMAKE_TOML_DEBUG][YMAKE_TOML_COMPRESS];
+    if(auto compressOn = compress.value<bool>())
+    {
+        proj.compressDebug = compressOn.value() ? YMAKE_DEBUG_COMPRESS_ZSTD : "";
+    }
+    else if(auto compressType = compress.value<std::string>())
+    {
+        if(compressType.value() == YMAKE_DEBUG_COMPRESS_ZSTD || compressType.value() == YMAKE_DEBUG_COMPRESS_ZLIB)
+        {
+            proj.compressDebug = compressType.value();
+        }
+        else
+        {
+            LLOG(YELLOW_TEXT("[YMAKE TOML WARN]: "), "unknown debug info compression (debug.compress) for project '",
+                 proj.name, "': ", compressType.value(), "\n");
+            LLOG(PURPLE_TEXT("\tdebug info isn't compressed. (expected zstd, zlib, true or false)\n"));
+        }
+    }
+
+    // strip release artifacts. (optional)
+    if(auto strip = mainTable[YMAKE_TOML_COMPILER][YMAKE_TOML_RELEASE][YMAKE_TOML_STRIP].value<bool>())
+        proj.strip = strip.value();
+
+    // release link preset. (optional)
+    if(auto linkPreset = mainTable[YMAKE_TOML_COMPILER][YMAKE_TOML_RELEASE][YMAKE_TOML_LINK_PRESET].value<bool>())
+        proj.linkPreset = linkPreset.value();
+
+    // release post-link optimization. (optional, needs a training command)
+    if(auto postLink = mainTable[YMAKE_TOML_COMPILER][YMAKE_TOML_RELEASE][YMAKE_TOML_POST_LINK].value<std::string>())
+    {
+        auto train = mainTable[YMAKE_TOML_COMPILER][YMAKE_TOML_RELEASE][YMAKE_TOML_TRAIN].value<std::string>();
+
+        if(postLink.value() != YMAKE_POST_LINK_BOLT && postLink.value() != YMAKE_POST_LINK_ORDER)
+        {
+            if(postLink.value() != YMAKE_POST_LINK_OFF)
+            {
+                LLOG(YELLOW_TEXT("[YMAKE TOML WARN]: "), "unknown post-link step (release.post_link) for project '",
+                     proj.name, "': ", postLink.value(), "\n");
+                LLOG(PURPLE_TEXT("\tpost-link is off. (expected bolt, order or off)\n"));
+            }
+        }
+        else if(!train)
+        {
+            LLOG(YELLOW_TEXT("[YMAKE TOML WARN]: "), "release.post_link needs a training command (release.train) for "
+                 "project '", proj.name, "'\n");
+            LLOG(PURPLE_TEXT("\tpost-link is off.\n"));
+        }
+        else
+        {
+            proj.postLink = postLink.value();
+            proj.train    = ExpandMacros(train.value(), dotenv);
+        }
+    }
+
     // debug defines.
     if(auto defines = mainTable[YMAKE_TOML_COMPILER][YMAKE_TOML_DEBUG][YMAKE_TOML_DEFINES].as_array())
     {
@@ -30,6 +30,13 @@ struct Library // dependency
     std::string path;
     BuildType type;
     std::string include;
+    std::string pch; // precompiled header (a path, or "auto"). empty -> none.
+    bool thinArchive = false; // static: the archive references the objects in YMakeCache instead of copying them.
+    std::string prelink;      // static: "on" or "gc" -> the objects are pre-linked in one object. empty -> off.
+    bool dual = false;        // type = ["static", "shared"]: also packaged as the other type. ('type' is the first)
+    std::string visibility;   // "hidden" -> only the symbols marked visible are exported. empty -> default.
+    std::vector<std::string> exports; // shared: the only dynamic symbols. (written as a version script)
+    std::string versionScript;        // shared: a version script given as is. (instead of exports)
 
     Library() {}
     Library(std::string name, std::string path) : name{name}, path{path} {}
@@ -126,6 +133,20 @@ class Project
     // build
     BuildType buildType;
     std::string buildDir;
+    u64 memoryBudget{}; // in MB. (0 -> a percentage of physical memory)
+
+    // unity (jumbo) build: sources are #included together in batches.
+    bool unity{};
+    std::vector<std::string> unityExclude; // files always compiled on their own.
+
+    // precompiled header: a path, or "auto" (picked from the sources' #includes). empty -> none.
+    std::string pch;
+
+    // build.linker: "auto", "mold", "lld", "gold" or "bfd". empty -> the compiler's default.
+    std::string linker;
+
+    // build.visibility: "hidden" -> -fvisibility=hidden. empty -> default. (libraries have their own)
+    std::string visibility;
 
     // libs
     std::vector<std::string> includeDirs;
@@ -141,6 +162,26 @@ class Project
     i32 optimizationDebug;
     i32 optimizationRelease;
 
+    // compiler.release.lto: "thin" or "full". empty -> off.
+    std::string lto;
+
+    // ymake build --pgo: "generate" or "use". empty -> off. (not saved in the cache)
+    std::string pgo;
+
+    // compiler.release.post_link: "bolt" or "order". empty -> off. train: the training command.
+    std::string postLink;
+    std::string train;
+
+    // debug info: compiler.debug.split_dwarf, compiler.debug.dwp, compiler.debug.compress ("zstd" or "zlib", empty ->
+    // off) and compiler.release.strip.
+    bool splitDwarf{};
+    bool dwp{};
+    std::string compressDebug;
+    bool strip{};
+
+    // compiler.release.link_preset: release links drop unused sections and unneeded libraries.
+    bool linkPreset{};
+
     std::vector<std::string> flagsDebug;
     std::vector<std::string> flagsRelease;
 
@@ -188,6 +229,46 @@ class Project
 
         oss << SerializeVector(flagsDebug);
         oss << SerializeVector(flagsRelease);
+
+        oss << memoryBudget << "\n";
+        oss << unity << "\n";
+        oss << SerializeVector(unityExclude);
+
+        oss << pch << "\n";
+        std::vector<std::string> libPchs;
+        for(auto lib : libs)
+            libPchs.push_back(lib.pch);
+        oss << SerializeVector(libPchs);
+
+        oss << linker << "\n";
+        oss << lto << "\n";
+        oss << postLink << "\n";
+        oss << train << "\n";
+        oss << splitDwarf << "\n" << dwp << "\n" << compressDebug << "\n" << strip << "\n";
+
+        // one character per library. ('1' -> thin archive)
+        std::string libThinArchives;
+        for(auto lib : libs)
+            libThinArchives += lib.thinArchive ? '1' : '0';
+        oss << libThinArchives << "\n";
+
+        oss << libs.size() << "\n";
+        for(auto lib : libs)
+            oss << lib.prelink << "\n";
+
+        // one character per library. ('1' -> dual)
+        std::string libDuals;
+        for(auto lib : libs)
+            libDuals += lib.dual ? '1' : '0';
+        oss << libDuals << "\n";
+
+        oss << visibility << "\n" << linkPreset << "\n";
+        oss << libs.size() << "\n";
+        for(auto lib : libs)
+        {
+            oss << lib.visibility << "\n" << lib.versionScript << "\n";
+            oss << SerializeVector(lib.exports);
+        }
         return oss.str();
     }
 
@@ -255,6 +336,88 @@ class Project
         LTRACE(true, "Deserializing flags...\n");
         flagsDebug   = DeserializeVector<std::string>(iss);
         flagsRelease = DeserializeVector<std::string>(iss);
+
+        // NOTE: fields below were added later, a cache from an older version might not have them.
+        if(std::getline(iss, line) && !line.empty())
+            memoryBudget = std::stoull(line);
+
+        if(std::getline(iss, line) && !line.empty())
+        {
+            unity        = (line == "1");
+            unityExclude = DeserializeVector<std::string>(iss);
+        }
+
+        // (pch is usually empty)
+        if(std::getline(iss, line))
+        {
+            pch = line;
+
+            std::vector<std::string> libPchs = DeserializeVector<std::string>(iss);
+            for(usize i = 0; i < libPchs.size() && i < libs.size(); i++)
+                libs[i].pch = libPchs[i];
+        }
+
+        if(std::getline(iss, line))
+            linker = line;
+
+        if(std::getline(iss, line))
+            lto = line;
+
+        if(std::getline(iss, line))
+        {
+            postLink = line;
+            std::getline(iss, train);
+        }
+
+        if(std::getline(iss, line) && !line.empty())
+        {
+            splitDwarf = (line == "1");
+            std::getline(iss, line);
+            dwp = (line == "1");
+            std::getline(iss, compressDebug);
+            std::getline(iss, line);
+            strip = (line == "1");
+        }
+
+        if(std::getline(iss, line))
+        {
+            for(usize i = 0; i < line.size() && i < libs.size(); i++)
+                libs[i].thinArchive = (line[i] == '1');
+        }
+
+        if(std::getline(iss, line) && !line.empty())
+        {
+            usize count = std::stoull(line);
+            for(usize i = 0; i < count && std::getline(iss, line); i++)
+            {
+                if(i < libs.size())
+                    libs[i].prelink = line;
+            }
+        }
+
+        if(std::getline(iss, line))
+        {
+            for(usize i = 0; i < line.size() && i < libs.size(); i++)
+                libs[i].dual = (line[i] == '1');
+        }
+
+        if(std::getline(iss, line))
+        {
+            visibility = line;
+            std::getline(iss, line);
+            linkPreset = (line == "1");
+        }
+
+        if(std::getline(iss, line) && !line.empty())
+        {
+            usize count = std::stoull(line);
+            for(usize i = 0; i < count && i < libs.size(); i++)
+            {
+                std::getline(iss, libs[i].visibility);
+                std::getline(iss, libs[i].versionScript);
+                libs[i].exports = DeserializeVector<std::string>(iss);
+            }
+        }
     }
 
     void OutputInfo()
@@ -290,6 +453,43 @@ class Project
         }
         LLOG("\n");
 
+        if(memoryBudget != 0)
+            LLOG(GREEN_TEXT("\tMemory Budget: "), memoryBudget, " MB\n");
+
+        if(!pch.empty())
+            LLOG(GREEN_TEXT("\tPrecompiled Header: "), pch, "\n");
+
+        if(!linker.empty())
+            LLOG(GREEN_TEXT("\tLinker: "), linker, "\n");
+
+        if(!lto.empty())
+            LLOG(GREEN_TEXT("\tLTO (release): "), lto, "\n");
+
+        if(!postLink.empty())
+            LLOG(GREEN_TEXT("\tPost-link (release): "), postLink, "\ttraining: ", train, "\n");
+
+        if(splitDwarf)
+            LLOG(GREEN_TEXT("\tSplit DWARF (debug): "), dwp ? "on, packaged with dwp\n" : "on\n");
+
+        if(!compressDebug.empty())
+            LLOG(GREEN_TEXT("\tCompressed Debug Info (debug): "), compressDebug, "\n");
+
+        if(strip)
+            LLOG(GREEN_TEXT("\tStrip (release): "), "on\n");
+
+        if(!visibility.empty())
+            LLOG(GREEN_TEXT("\tVisibility: "), visibility, "\n");
+
+        if(linkPreset)
+            LLOG(GREEN_TEXT("\tLink Preset (release): "), "on\n");
+
+        if(unity)
+        {
+            LLOG(GREEN_TEXT("\tUnity Build: "), "on\n");
+            for(std::string file : unityExclude)
+                LLOG("\t\texcluded: ", file, "\n");
+        }
+
         LLOG(CYAN_TEXT("\tSource Directory: "), src, "\n");
         if(env != "")
             LLOG(CYAN_TEXT("\t.env Directory: "), env, "\n");
@@ -311,8 +511,25 @@ class Project
                      lib.type == BuildType::EXECUTABLE   ? "Executable"
                      : lib.type == BuildType::SHARED_LIB ? "Shared (Dynamic) Library"
                                                          : "Static Library",
+                     !lib.dual                           ? ""
+                     : lib.type == BuildType::SHARED_LIB ? " + Static Library"
+                                                         : " + Shared (Dynamic) Library",
                      "\n");
                 LLOG("\t\t\tInclude: ", lib.include, "\n");
+                if(lib.thinArchive)
+                    LLOG("\t\t\tThin Archive: yes\n");
+                if(!lib.prelink.empty())
+                    LLOG("\t\t\tPrelink: ", lib.prelink, "\n");
+                if(!lib.visibility.empty())
+                    LLOG("\t\t\tVisibility: ", lib.visibility, "\n");
+                if(!lib.versionScript.empty())
+                {
+                    LLOG("\t\t\tVersion Script: ", lib.versionScript, "\n");
+                }
+                else if(!lib.exports.empty())
+                {
+                    LLOG("\t\t\tExports: ", lib.exports.size(), " symbols\n");
+                }
             }
         }
 
@@ -404,6 +621,9 @@ std::optional<T> GetValueFromTOML(const toml::table &tbl, const std::string &key
 
 void ParseProjectData(const toml::table &config, Project &proj);
 
+// "4096", "4096M", "4G" -> size in MB
+u64 ToMegabytes(const std::string &str);
+
 Project LoadProjectFromConfig(const char *filepath, const char *projName);
 std::vector<Project> LoadProjectsFromConfig(const char *filepath);
 